@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+#include <chrono>
+#include <iomanip>
+
+BenchmarkRunner::BenchmarkRunner(double minSeconds, const std::string& filter)
+    : minSeconds(minSeconds), filter(filter) {}
+
+void BenchmarkRunner::run(const std::string& name, const std::function<void(uint64_t)>& body) {
+    if (name.find(filter) == std::string::npos) return;
+
+    uint64_t operations = 1;
+    while (true) {
+        uint64_t allocationsBefore = allocationCount();
+        auto start = std::chrono::steady_clock::now();
+        body(operations);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t allocated = allocationCount() - allocationsBefore;
+
+        if (elapsed >= minSeconds) {
+            results.push_back({name, operations, elapsed * 1e9 / operations,
+                               static_cast<double>(allocated) / operations, operations / elapsed});
+            return;
+        }
+
+        // Aim a little past the target so the next call usually makes it,
+        // growing at most 100x at a time while calls are too short to time
+        double scale = elapsed > 0 ? minSeconds * 1.2 / elapsed : 100.0;
+        if (scale > 100.0) scale = 100.0;
+        if (scale < 2.0) scale = 2.0;
+        operations = static_cast<uint64_t>(operations * scale);
+    }
+}
+
+void BenchmarkRunner::printTable(std::ostream& out) const {
+    out << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(14) << "ns/op"
+        << std::setw(14) << "allocs/op" << std::setw(16) << "ops/sec" << '\n';
+    for (const Result& result : results) {
+        out << std::left << std::setw(28) << result.name << std::right << std::fixed
+            << std::setw(14) << std::setprecision(1) << result.nsPerOp
+            << std::setw(14) << std::setprecision(2) << result.allocationsPerOp
+            << std::setw(16) << std::setprecision(0) << result.opsPerSecond << '\n';
+    }
+}
+
+void BenchmarkRunner::writeJson(std::ostream& out) const {
+    // Benchmark names are plain identifiers, so nothing needs escaping
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << "    {\"name\": \"" << result.name << "\""
+            << ", \"operations\": " << result.operations << std::fixed
+            << ", \"ns_per_op\": " << std::setprecision(2) << result.nsPerOp
+            << ", \"allocs_per_op\": " << std::setprecision(3) << result.allocationsPerOp
+            << ", \"ops_per_sec\": " << std::setprecision(0) << result.opsPerSecond << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
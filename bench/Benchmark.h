@@ -0,0 +1,45 @@
+#pragma once
+#include "Metrics.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+// Keeps the compiler from optimizing away a value a benchmark computes
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Runs benchmark bodies and collects their results. A body is called with
+// an operation count and must perform that many operations; the runner
+// grows the count until one call takes at least minSeconds, then reports
+// that call.
+class BenchmarkRunner {
+public:
+    struct Result {
+        std::string name;
+        uint64_t operations;
+        double nsPerOp;
+        double allocationsPerOp;
+        double opsPerSecond;
+    };
+
+private:
+    double minSeconds;
+    std::string filter;
+    std::vector<Result> results;
+
+public:
+    // Only benchmarks whose names contain filter are run
+    BenchmarkRunner(double minSeconds, const std::string& filter);
+
+    void run(const std::string& name, const std::function<void(uint64_t)>& body);
+    const std::vector<Result>& getResults() const { return results; }
+
+    // A human-readable table, and JSON for tracking results across releases
+    void printTable(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+};
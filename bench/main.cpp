@@ -0,0 +1,229 @@
+#include "Benchmark.h"
+#include "GameEngine.h"
+#include "GameIO.h"
+#include "FileManager.h"
+#include "CommandParser.h"
+#include "Inventory.h"
+#include "Player.h"
+#include "Metrics.h"
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint64_t SEED = 1;
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--filter TEXT] [--time SECONDS] [--json FILE]" << std::endl;
+    std::cerr << "  --filter TEXT    Only run benchmarks whose names contain TEXT" << std::endl;
+    std::cerr << "  --time SECONDS   Minimum time to run each benchmark for (default 0.5)" << std::endl;
+    std::cerr << "  --json FILE      Also write the results to FILE as JSON" << std::endl;
+}
+
+// A session that has entered its name and stands in the first room
+std::unique_ptr<GameEngine> startSession(OutputSink& output, std::shared_ptr<const GameData> data,
+                                         const std::vector<std::string>& lines) {
+    auto game = std::make_unique<GameEngine>(output, data, SEED);
+    game->beginSession();
+    game->handleLine("Hero");
+    for (const auto& line : lines) {
+        game->handleLine(line);
+    }
+    game->flushOutput();
+    return game;
+}
+
+void benchParse(BenchmarkRunner& runner) {
+    const std::vector<std::string> lines = {
+        "look", "  Take   Health Potion ", "go north", "use ancient key",
+        "INVENTORY", "attack goblin", "travel misty forest", "xyzzy"
+    };
+    runner.run("parse_command", [&lines](uint64_t operations) {
+        std::string buffer;
+        Command command;
+        for (uint64_t i = 0; i < operations; ++i) {
+            buffer.assign(lines[i % lines.size()]);
+            parseCommandLine(buffer, command);
+            keep(command);
+        }
+    });
+}
+
+void benchDispatch(BenchmarkRunner& runner, std::shared_ptr<const GameData> data) {
+    // Commands that leave the session where it is, each a full turn
+    const std::vector<std::string> lines = {"inventory", "memory", "status", "look", "xyzzy"};
+    auto dispatch = [&](uint64_t operations, Metrics* metrics) {
+        NullSink output;
+        auto game = startSession(output, data, {});
+        game->measureTo(metrics);
+        for (uint64_t i = 0; i < operations; ++i) {
+            game->handleLine(lines[i % lines.size()]);
+            game->flushOutput();
+        }
+        keep(output.bytesWritten());
+    };
+    runner.run("process_command", [&](uint64_t operations) {
+        dispatch(operations, nullptr);
+    });
+
+    // The same with handler timing and counters on, for their overhead
+    Metrics metrics;
+    runner.run("process_command_metrics", [&](uint64_t operations) {
+        dispatch(operations, &metrics);
+    });
+}
+
+void benchDisplayRoom(BenchmarkRunner& runner, std::shared_ptr<const GameData> data) {
+    runner.run("display_room", [&](uint64_t operations) {
+        NullSink output;
+        Renderer out(output);
+        NullSink sessionOutput;
+        auto game = startSession(sessionOutput, data, {});
+        const World& world = game->getWorld();
+        const Room& room = world.room(game->getCurrentRoomId());
+        for (uint64_t i = 0; i < operations; ++i) {
+            room.displayRoom(out, world);
+            out.flushTurn();
+        }
+        keep(output.bytesWritten());
+    });
+}
+
+void benchMove(BenchmarkRunner& runner, std::shared_ptr<const GameData> data) {
+    // Back and forth between the village and the temple, neither of which
+    // has encounters or hazards
+    runner.run("handle_move", [&](uint64_t operations) {
+        NullSink output;
+        auto game = startSession(output, data, {});
+        for (uint64_t i = 0; i < operations; ++i) {
+            game->handleLine(i % 2 == 0 ? "east" : "west");
+            game->flushOutput();
+        }
+        keep(output.bytesWritten());
+    });
+}
+
+void benchInventory(BenchmarkRunner& runner, std::shared_ptr<const GameData> data) {
+    // One operation is an add, a count and a remove
+    runner.run("inventory_ids", [&](uint64_t operations) {
+        Inventory inventory;
+        ItemId itemCount = static_cast<ItemId>(data->items.size());
+        for (ItemId item = 0; item < itemCount; item += 2) {
+            inventory.add(item);
+        }
+        for (uint64_t i = 0; i < operations; ++i) {
+            ItemId item = static_cast<ItemId>(i % itemCount);
+            inventory.add(item);
+            keep(inventory.count(item));
+            inventory.remove(item);
+        }
+    });
+
+    // Lookups by name as the command handlers make them
+    runner.run("inventory_names", [&](uint64_t operations) {
+        NullSink output;
+        Renderer out(output);
+        Player player("Hero", *data);
+        for (size_t item = 0; item < data->items.size(); item += 2) {
+            player.addItem(data->items[item], out);
+        }
+        out.flushTurn();
+        for (uint64_t i = 0; i < operations; ++i) {
+            const std::string& name = data->items[i % data->items.size()].getName();
+            keep(player.hasItem(name));
+            keep(player.getItem(name));
+        }
+    });
+}
+
+void benchCombat(BenchmarkRunner& runner, std::shared_ptr<const GameData> data) {
+    // One operation is a round of an unarmed fight with the boss. Fights
+    // are forked from a session waiting in combat and replaced as they end.
+    NullSink setupOutput;
+    auto fight = startSession(setupOutput, data, {"east", "north", "attack"});
+    if (fight->getInputState() != GameEngine::InputState::COMBAT_CHOICE) {
+        throw std::runtime_error("combat benchmark did not reach a fight");
+    }
+
+    runner.run("combat_round", [&](uint64_t operations) {
+        NullSink output;
+        auto game = fight->fork(output);
+        for (uint64_t i = 0; i < operations; ++i) {
+            if (game->getInputState() != GameEngine::InputState::COMBAT_CHOICE) {
+                game = fight->fork(output);
+            }
+            game->handleLine("1");
+            game->flushOutput();
+        }
+        keep(output.bytesWritten());
+    });
+}
+
+void benchStartup(BenchmarkRunner& runner, std::shared_ptr<const GameData> data) {
+    // A whole session start: construction, the banner, then populating
+    // the world once the name is in
+    runner.run("session_startup", [&](uint64_t operations) {
+        NullSink output;
+        for (uint64_t i = 0; i < operations; ++i) {
+            GameEngine game(output, data, SEED, i);
+            game.beginSession();
+            game.handleLine("Hero");
+            game.flushOutput();
+        }
+        keep(output.bytesWritten());
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        std::string filter;
+        std::string jsonPath;
+        double seconds = 0.5;
+        for (size_t i = 0; i < args.size(); i += 2) {
+            if (i + 1 >= args.size()) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            if (args[i] == "--filter") {
+                filter = args[i + 1];
+            } else if (args[i] == "--time") {
+                seconds = std::stod(args[i + 1]);
+            } else if (args[i] == "--json") {
+                jsonPath = args[i + 1];
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        std::shared_ptr<const GameData> data = FileManager::builtinData();
+        BenchmarkRunner runner(seconds, filter);
+        benchParse(runner);
+        benchDispatch(runner, data);
+        benchDisplayRoom(runner, data);
+        benchMove(runner, data);
+        benchInventory(runner, data);
+        benchCombat(runner, data);
+        benchStartup(runner, data);
+
+        runner.printTable(std::cout);
+        if (!jsonPath.empty()) {
+            std::ofstream file(jsonPath);
+            runner.writeJson(file);
+            if (!file) {
+                throw std::runtime_error("Cannot write " + jsonPath);
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
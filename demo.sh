@@ -50,8 +50,9 @@ EOF
 echo "Running game with demo inputs..."
 echo ""
 
-# Run the game with demo input
-./echoes_game < demo_input.txt
+# Run the game with demo input. A fixed seed makes every run of the demo
+# the same, and the journal can be replayed with --replay demo.journal
+./echoes_game --seed 1 --record demo.journal < demo_input.txt
 
 echo ""
 echo "=== DEMO COMPLETED ==="
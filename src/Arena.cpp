@@ -0,0 +1,33 @@
+#include "Arena.h"
+
+Arena::FreeList* Arena::listFor(size_t bytes, size_t alignment) {
+    for (FreeList& list : freeLists) {
+        if (list.bytes == bytes && list.alignment == alignment) return &list;
+    }
+    return nullptr;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    bytes = blockSize(bytes);
+    std::lock_guard<std::mutex> guard(lock);
+    FreeList* list = listFor(bytes, alignment);
+    if (list && list->head) {
+        FreeBlock* block = list->head;
+        list->head = block->next;
+        return block;
+    }
+    return buffers.allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void* block, size_t bytes, size_t alignment) {
+    bytes = blockSize(bytes);
+    std::lock_guard<std::mutex> guard(lock);
+    FreeList* list = listFor(bytes, alignment);
+    if (!list) {
+        freeLists.push_back({bytes, alignment, nullptr});
+        list = &freeLists.back();
+    }
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = list->head;
+    list->head = freed;
+}
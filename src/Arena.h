@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+// Memory for one session's world. Blocks are carved one after another out
+// of a few large buffers, which are all freed together when the arena
+// goes, however many objects were made from it. A freed block is kept on a
+// list for its size and handed to the next allocation of that size, since a
+// world makes and drops rooms and pages as it forks and evicts but only of
+// a few sizes.
+//
+// Forks of a world share its arena and the solver runs them on several
+// threads, so allocation takes a lock; it is never contended for long.
+class Arena : public std::pmr::memory_resource {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct FreeList {
+        size_t bytes;
+        size_t alignment;
+        FreeBlock* head;
+    };
+
+    std::mutex lock;
+    std::pmr::monotonic_buffer_resource buffers;
+    std::vector<FreeList> freeLists;    // one per size seen, so only a handful
+
+    static size_t blockSize(size_t bytes) { return bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : bytes; }
+    FreeList* listFor(size_t bytes, size_t alignment);
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* block, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    static constexpr size_t INITIAL_BUFFER = 2048;
+
+    Arena() : buffers(INITIAL_BUFFER) {}
+};
+
+// A standard allocator over an arena that keeps the arena alive for as long
+// as anything it allocated, for std::allocate_shared
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    std::shared_ptr<Arena> arena;
+
+    explicit ArenaAllocator(std::shared_ptr<Arena> arena) : arena(std::move(arena)) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) { arena->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
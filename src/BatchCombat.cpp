@@ -0,0 +1,111 @@
+#include "BatchCombat.h"
+#include <algorithm>
+
+BatchCombat::BatchCombat(uint64_t seed) : seeder(seed) {}
+
+BatchCombat::Stats BatchCombat::statsOf(const Player& player) {
+    return Stats{player.getHealth(), player.getAttack(), player.getDefense()};
+}
+
+BatchCombat::Stats BatchCombat::statsOf(const Enemy& enemy) {
+    return Stats{enemy.getHealth(), enemy.getAttack(), enemy.getDefense()};
+}
+
+void BatchCombat::addFights(const Stats& player, const Stats& enemy, size_t count) {
+    size_t total = size() + count;
+    playerHealth.resize(total, player.health);
+    playerAttack.resize(total, player.attack);
+    playerDefense.resize(total, player.defense);
+    enemyHealth.resize(total, enemy.health);
+    enemyAttack.resize(total, enemy.attack);
+    enemyDefense.resize(total, enemy.defense);
+    rounds.resize(total, 0);
+
+    // Every fight gets its own xorshift32 stream so lanes never share state
+    rngState.reserve(total);
+    for (size_t i = 0; i < count; ++i) {
+        rngState.push_back(seeder.next() | 1u);
+    }
+}
+
+void BatchCombat::clear() {
+    playerHealth.clear();
+    playerAttack.clear();
+    playerDefense.clear();
+    enemyHealth.clear();
+    enemyAttack.clear();
+    enemyDefense.clear();
+    rounds.clear();
+    rngState.clear();
+}
+
+size_t BatchCombat::resolveRound() {
+    const size_t n = size();
+    int32_t* __restrict ph = playerHealth.data();
+    const int32_t* __restrict pa = playerAttack.data();
+    const int32_t* __restrict pd = playerDefense.data();
+    int32_t* __restrict eh = enemyHealth.data();
+    const int32_t* __restrict ea = enemyAttack.data();
+    const int32_t* __restrict ed = enemyDefense.data();
+    int32_t* __restrict rc = rounds.data();
+    uint32_t* __restrict rng = rngState.data();
+
+    int32_t active = 0;
+#pragma omp simd reduction(+:active)
+    for (size_t i = 0; i < n; ++i) {
+        int32_t fighting = (ph[i] > 0) & (eh[i] > 0);
+
+        // Player strikes first (EnemyStore::takeDamage)
+        int32_t playerHit = std::max(1, pa[i] - ed[i]);
+        int32_t enemyLeft = std::max(0, eh[i] - playerHit);
+        eh[i] = fighting ? enemyLeft : eh[i];
+
+        // EnemyStore::performAttack rolls attack +/- 2, then Player::takeDamage applies defense
+        uint32_t x = rng[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        rng[i] = x;
+        int32_t roll = ea[i] - 2 + static_cast<int32_t>(((x >> 16) * 5u) >> 16);
+        int32_t enemyHit = std::max(1, std::max(1, roll) - pd[i]);
+        int32_t answers = fighting & (eh[i] > 0);
+        int32_t playerLeft = std::max(0, ph[i] - enemyHit);
+        ph[i] = answers ? playerLeft : ph[i];
+
+        rc[i] += fighting;
+        active += answers & (ph[i] > 0);
+    }
+    return static_cast<size_t>(active);
+}
+
+void BatchCombat::resolveAll(int maxRounds) {
+    for (int round = 0; round < maxRounds; ++round) {
+        if (resolveRound() == 0) break;
+    }
+}
+
+BatchCombat::Summary BatchCombat::summarize() const {
+    Summary summary{size(), 0, 0, 0, 0.0, 0.0};
+    long long totalRounds = 0;
+    long long winnerHealth = 0;
+
+    for (size_t i = 0; i < size(); ++i) {
+        totalRounds += rounds[i];
+        if (enemyHealth[i] <= 0) {
+            summary.playerWins++;
+            winnerHealth += playerHealth[i];
+        } else if (playerHealth[i] <= 0) {
+            summary.enemyWins++;
+        } else {
+            summary.unresolved++;
+        }
+    }
+
+    if (summary.fights > 0) {
+        summary.averageRounds = static_cast<double>(totalRounds) / summary.fights;
+    }
+    if (summary.playerWins > 0) {
+        summary.averagePlayerHealth = static_cast<double>(winnerHealth) / summary.playerWins;
+    }
+    return summary;
+}
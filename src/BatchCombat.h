@@ -0,0 +1,59 @@
+#pragma once
+#include "Player.h"
+#include "Enemy.h"
+#include "Random.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Resolves many player-vs-enemy fights at once for balance simulation.
+// Fights are kept in structure-of-arrays form and every round runs one
+// branch-free pass over all of them so the compiler can vectorize it.
+// Rules match the interactive combat: the player strikes first for
+// max(1, attack - defense), the enemy answers with an attack roll of
+// attack +/- 2 (at least 1), reduced by the player's defense (at least 1).
+class BatchCombat {
+public:
+    struct Stats {
+        int health;
+        int attack;
+        int defense;
+    };
+
+    struct Summary {
+        size_t fights;
+        size_t playerWins;
+        size_t enemyWins;
+        size_t unresolved;
+        double averageRounds;
+        double averagePlayerHealth;   // health left after the fights the player won
+    };
+
+private:
+    std::vector<int32_t> playerHealth;
+    std::vector<int32_t> playerAttack;
+    std::vector<int32_t> playerDefense;
+    std::vector<int32_t> enemyHealth;
+    std::vector<int32_t> enemyAttack;
+    std::vector<int32_t> enemyDefense;
+    std::vector<int32_t> rounds;
+    std::vector<uint32_t> rngState;
+    Random seeder;
+
+public:
+    explicit BatchCombat(uint64_t seed);
+
+    static Stats statsOf(const Player& player);
+    static Stats statsOf(const Enemy& enemy);
+
+    void addFights(const Stats& player, const Stats& enemy, size_t count = 1);
+    void clear();
+    size_t size() const { return playerHealth.size(); }
+
+    // Resolves one round of every fight, returns how many are still going
+    size_t resolveRound();
+    // Resolves rounds until every fight is over or maxRounds is reached
+    void resolveAll(int maxRounds = 1000);
+
+    Summary summarize() const;
+};
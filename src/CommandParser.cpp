@@ -0,0 +1,125 @@
+#include "CommandParser.h"
+#include <cctype>
+
+namespace {
+
+struct VerbEntry {
+    std::string_view word;
+    Verb verb;
+};
+
+constexpr VerbEntry VERBS[] = {
+    {"look", Verb::LOOK}, {"l", Verb::LOOK},
+    {"move", Verb::MOVE}, {"go", Verb::MOVE}, {"m", Verb::MOVE},
+    {"north", Verb::NORTH}, {"n", Verb::NORTH},
+    {"south", Verb::SOUTH}, {"s", Verb::SOUTH},
+    {"east", Verb::EAST}, {"e", Verb::EAST},
+    {"west", Verb::WEST}, {"w", Verb::WEST},
+    {"take", Verb::TAKE}, {"get", Verb::TAKE}, {"pick", Verb::TAKE},
+    {"use", Verb::USE},
+    {"attack", Verb::ATTACK}, {"fight", Verb::ATTACK},
+    {"inventory", Verb::INVENTORY}, {"i", Verb::INVENTORY}, {"inv", Verb::INVENTORY},
+    {"memory", Verb::MEMORY}, {"journal", Verb::MEMORY},
+    {"save", Verb::SAVE},
+    {"load", Verb::LOAD},
+    {"help", Verb::HELP}, {"h", Verb::HELP},
+    {"quit", Verb::QUIT}, {"exit", Verb::QUIT}, {"q", Verb::QUIT},
+    {"status", Verb::STATUS}, {"stats", Verb::STATUS},
+    {"travel", Verb::TRAVEL},
+    {"metrics", Verb::METRICS},
+};
+
+const uint32_t TABLE_BITS = 8;
+const size_t TABLE_SIZE = size_t(1) << TABLE_BITS;
+const uint32_t NO_SEED = 0xffffffffu;
+
+constexpr size_t slotOf(std::string_view word, uint32_t seed) {
+    // FNV-1a with a seeded offset basis; the top bits are the best mixed
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : word) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash >> (32 - TABLE_BITS);
+}
+
+struct VerbTable {
+    uint32_t seed;
+    std::array<VerbEntry, TABLE_SIZE> slots;
+};
+
+// Searches, at compile time, for a hash seed that gives every word its own
+// slot, so a lookup is one hash and one compare
+constexpr VerbTable buildVerbTable() {
+    for (uint32_t seed = 0; seed < 64; ++seed) {
+        VerbTable table{seed, {}};
+        bool perfect = true;
+        for (const auto& entry : VERBS) {
+            auto& slot = table.slots[slotOf(entry.word, seed)];
+            if (slot.verb != Verb::NONE) {
+                perfect = false;
+                break;
+            }
+            slot = entry;
+        }
+        if (perfect) {
+            return table;
+        }
+    }
+    return VerbTable{NO_SEED, {}};
+}
+
+constexpr VerbTable VERB_TABLE = buildVerbTable();
+static_assert(VERB_TABLE.seed != NO_SEED, "No perfect hash seed for the verb table; grow TABLE_SIZE");
+
+} // namespace
+
+Verb lookupVerb(std::string_view word) {
+    const VerbEntry& slot = VERB_TABLE.slots[slotOf(word, VERB_TABLE.seed)];
+    return slot.word == word ? slot.verb : Verb::NONE;
+}
+
+std::string_view normalizeLine(std::string& line) {
+    size_t length = 0;
+    bool pendingSpace = false;
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(line[i]);
+        if (std::isspace(c)) {
+            pendingSpace = length > 0;
+            continue;
+        }
+        if (pendingSpace) {
+            line[length++] = ' ';
+            pendingSpace = false;
+        }
+        line[length++] = static_cast<char>(std::tolower(c));
+    }
+
+    // Shrinking never reallocates
+    line.resize(length);
+    return line;
+}
+
+void parseCommandLine(std::string& line, Command& command) {
+    std::string_view text = normalizeLine(line);
+
+    command.count = 0;
+    command.rest = std::string_view();
+    command.verb = Verb::NONE;
+
+    size_t start = 0;
+    while (start < text.size() && command.count < Command::MAX_TOKENS) {
+        size_t end = text.find(' ', start);
+        if (end == std::string_view::npos) end = text.size();
+        command.tokens[command.count++] = text.substr(start, end - start);
+        start = end + 1;
+    }
+
+    if (command.count > 0) {
+        command.verb = lookupVerb(command.tokens[0]);
+        if (command.count > 1) {
+            command.rest = text.substr(command.tokens[0].size() + 1);
+        }
+    }
+}
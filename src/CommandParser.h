@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Every verb the command prompt understands; aliases map to the same verb
+enum class Verb : uint8_t {
+    NONE,
+    LOOK,
+    MOVE,
+    NORTH,
+    SOUTH,
+    EAST,
+    WEST,
+    TAKE,
+    USE,
+    ATTACK,
+    INVENTORY,
+    MEMORY,
+    SAVE,
+    LOAD,
+    HELP,
+    QUIT,
+    STATUS,
+    TRAVEL,
+    METRICS
+};
+
+// One parsed command line. The views point into the line buffer that was
+// tokenized, so a Command is only valid while that buffer is unchanged.
+struct Command {
+    static const size_t MAX_TOKENS = 16;
+
+    std::array<std::string_view, MAX_TOKENS> tokens;
+    size_t count = 0;
+    std::string_view rest;   // everything after the first word, single-spaced
+    Verb verb = Verb::NONE;
+
+    bool empty() const { return count == 0; }
+    std::string_view word(size_t i) const { return i < count ? tokens[i] : std::string_view(); }
+};
+
+// Lowercases the line in place, collapses runs of whitespace to single
+// spaces and trims it, returning a view of the result
+std::string_view normalizeLine(std::string& line);
+
+// Normalizes the line and splits it into a Command, no heap allocation
+void parseCommandLine(std::string& line, Command& command);
+
+// Maps a verb or alias ("look", "l", "go", ...) to its Verb, or Verb::NONE
+Verb lookupVerb(std::string_view word);
@@ -0,0 +1,29 @@
+#include "Direction.h"
+
+const char* directionName(Direction direction) {
+    switch (direction) {
+        case Direction::NORTH: return "north";
+        case Direction::SOUTH: return "south";
+        case Direction::EAST: return "east";
+        case Direction::WEST: return "west";
+        default: return "nowhere";
+    }
+}
+
+Direction parseDirection(std::string_view name) {
+    if (name == "north" || name == "n") return Direction::NORTH;
+    if (name == "south" || name == "s") return Direction::SOUTH;
+    if (name == "east" || name == "e") return Direction::EAST;
+    if (name == "west" || name == "w") return Direction::WEST;
+    return Direction::NONE;
+}
+
+Direction oppositeDirection(Direction direction) {
+    switch (direction) {
+        case Direction::NORTH: return Direction::SOUTH;
+        case Direction::SOUTH: return Direction::NORTH;
+        case Direction::EAST: return Direction::WEST;
+        case Direction::WEST: return Direction::EAST;
+        default: return Direction::NONE;
+    }
+}
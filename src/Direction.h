@@ -0,0 +1,26 @@
+#pragma once
+#include <array>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Rooms are interned to dense integer ids, the index into World's arrays
+using RoomId = uint32_t;
+const RoomId NO_ROOM = UINT32_MAX;
+
+enum class Direction : uint8_t {
+    NORTH,
+    SOUTH,
+    EAST,
+    WEST,
+    NONE        // not a direction; every lookup with it finds no exit
+};
+
+const size_t DIRECTION_COUNT = 4;
+
+// One room's exits, indexed by Direction
+using ExitRow = std::array<RoomId, DIRECTION_COUNT>;
+
+const char* directionName(Direction direction);
+Direction parseDirection(std::string_view name);
+Direction oppositeDirection(Direction direction);
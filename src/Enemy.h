@@ -1,7 +1,8 @@
 #pragma once
 #include <string>
-#include <random>
 
+// Stats of one kind of enemy. Live enemies are spawned from these into the
+// World's EnemyStore, which tracks their health and position.
 class Enemy {
 public:
     enum class Type {
@@ -16,35 +17,25 @@ private:
     std::string name;
     Type type;
     int health;
-    int maxHealth;
     int attack;
     int defense;
     int goldReward;
-    bool isAlive;
-    static std::mt19937 rng;
+    bool roaming;
 
 public:
-    Enemy(const std::string& name, Type type, int health, int attack, int defense, int goldReward);
-    
-    // Combat
-    int performAttack();
-    void takeDamage(int damage);
-    bool alive() const { return isAlive && health > 0; }
+    Enemy(const std::string& name, Type type, int health, int attack, int defense, int goldReward, bool roaming = false);
     
     // Getters
     const std::string& getName() const { return name; }
     Type getType() const { return type; }
     int getHealth() const { return health; }
-    int getMaxHealth() const { return maxHealth; }
     int getAttack() const { return attack; }
     int getDefense() const { return defense; }
     int getGoldReward() const { return goldReward; }
+    // Whether ones placed in rooms wander the world (random encounters
+    // left behind always do)
+    bool isRoaming() const { return roaming; }
     
     // Display
-    void showStatus() const;
     std::string getTypeString() const;
-    
-    // Factory method
-    static Enemy createRandomEnemy();
-    static Enemy createBoss();
 };
@@ -0,0 +1,368 @@
+#include "EnemyStore.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+#include <algorithm>
+
+// A geometric draw, two bits of a roll per turn
+uint32_t EnemyStore::moveDelay(Random& rng) {
+    uint32_t delay = 1;
+    for (;;) {
+        uint32_t roll = rng.next();
+        for (int turn = 0; turn < 16; ++turn, roll >>= 2) {
+            if ((roll & 3u) == 0) return delay;
+            delay++;
+        }
+    }
+}
+
+uint32_t EnemyStore::internTemplate(const Enemy& spec) {
+    auto it = templateIds.find(spec.getName());
+    if (it != templateIds.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(templates.size());
+    templates.push_back(spec);
+    templateIds.emplace(spec.getName(), id);
+    return id;
+}
+
+void EnemyStore::reserve(size_t enemyCount) {
+    health.reserve(enemyCount);
+    maxHealth.reserve(enemyCount);
+    attack.reserve(enemyCount);
+    defense.reserve(enemyCount);
+    templateOf.reserve(enemyCount);
+    room.reserve(enemyCount);
+    alive.reserve(enemyCount);
+    roaming.reserve(enemyCount);
+    nextInRoom.reserve(enemyCount);
+    prevInRoom.reserve(enemyCount);
+}
+
+void EnemyStore::clear() {
+    health.clear();
+    maxHealth.clear();
+    attack.clear();
+    defense.clear();
+    templateOf.clear();
+    room.clear();
+    alive.clear();
+    roaming.clear();
+    nextInRoom.clear();
+    prevInRoom.clear();
+    roomHead.clear();
+    roomTail.clear();
+    hurt.clear();
+    unscheduled.clear();
+    freeIds.clear();
+}
+
+EnemyId EnemyStore::add(const Enemy& spec, bool roams) {
+    if (!freeIds.empty()) {
+        EnemyId id = freeIds.back();
+        freeIds.pop_back();
+        health[id] = spec.getHealth();
+        maxHealth[id] = spec.getHealth();
+        attack[id] = spec.getAttack();
+        defense[id] = spec.getDefense();
+        templateOf[id] = internTemplate(spec);
+        alive[id] = 1;
+        roaming[id] = roams ? 1 : 0;
+        return id;
+    }
+
+    EnemyId id = static_cast<EnemyId>(health.size());
+    health.push_back(spec.getHealth());
+    maxHealth.push_back(spec.getHealth());
+    attack.push_back(spec.getAttack());
+    defense.push_back(spec.getDefense());
+    templateOf.push_back(internTemplate(spec));
+    room.push_back(NO_ROOM);
+    alive.push_back(1);
+    roaming.push_back(roams ? 1 : 0);
+    nextInRoom.push_back(NO_ENEMY);
+    prevInRoom.push_back(NO_ENEMY);
+    return id;
+}
+
+EnemyId EnemyStore::spawn(const Enemy& spec, RoomId target, bool roams) {
+    EnemyId id = add(spec, roams);
+    link(id, target);
+    if (roams) {
+        unscheduled.push_back(id);
+    }
+    return id;
+}
+
+EnemyId EnemyStore::spawnFirst(const Enemy& spec, RoomId target, bool roams) {
+    EnemyId id = add(spec, roams);
+    link(id, target, true);
+    if (roams) {
+        unscheduled.push_back(id);
+    }
+    return id;
+}
+
+void EnemyStore::link(EnemyId id, RoomId target, bool first) {
+    if (target >= roomHead.size()) {
+        roomHead.resize(target + 1, NO_ENEMY);
+        roomTail.resize(target + 1, NO_ENEMY);
+    }
+    room[id] = target;
+
+    if (first) {
+        prevInRoom[id] = NO_ENEMY;
+        nextInRoom[id] = roomHead[target];
+        if (roomHead[target] != NO_ENEMY) {
+            prevInRoom[roomHead[target]] = id;
+        } else {
+            roomTail[target] = id;
+        }
+        roomHead[target] = id;
+        return;
+    }
+
+    // Append, so a room lists its enemies in arrival order
+    nextInRoom[id] = NO_ENEMY;
+    prevInRoom[id] = roomTail[target];
+    if (roomTail[target] != NO_ENEMY) {
+        nextInRoom[roomTail[target]] = id;
+    } else {
+        roomHead[target] = id;
+    }
+    roomTail[target] = id;
+}
+
+void EnemyStore::unlink(EnemyId id) {
+    RoomId from = room[id];
+    if (prevInRoom[id] != NO_ENEMY) {
+        nextInRoom[prevInRoom[id]] = nextInRoom[id];
+    } else {
+        roomHead[from] = nextInRoom[id];
+    }
+    if (nextInRoom[id] != NO_ENEMY) {
+        prevInRoom[nextInRoom[id]] = prevInRoom[id];
+    } else {
+        roomTail[from] = prevInRoom[id];
+    }
+    nextInRoom[id] = NO_ENEMY;
+    prevInRoom[id] = NO_ENEMY;
+    room[id] = NO_ROOM;
+}
+
+void EnemyStore::release(EnemyId id) {
+    freeIds.push_back(id);
+}
+
+void EnemyStore::kill(EnemyId id) {
+    if (!alive[id]) return;
+    alive[id] = 0;
+    health[id] = 0;
+    unlink(id);
+
+    auto wasHurt = std::find(hurt.begin(), hurt.end(), id);
+    if (wasHurt != hurt.end()) {
+        *wasHurt = hurt.back();
+        hurt.pop_back();
+    }
+    // A wanderer still has a move on the wheel, or is waiting for its
+    // first; its id is freed when that comes round
+    if (!roaming[id]) {
+        release(id);
+    }
+}
+
+size_t EnemyStore::countInRoom(RoomId id, size_t limit) const {
+    size_t count = 0;
+    for (EnemyId enemy = firstInRoom(id); enemy != NO_ENEMY && count < limit; enemy = nextInRoom[enemy]) {
+        count++;
+    }
+    return count;
+}
+
+void EnemyStore::moveTo(EnemyId id, RoomId target) {
+    if (!alive[id] || room[id] == target) return;
+    unlink(id);
+    link(id, target);
+}
+
+int EnemyStore::performAttack(EnemyId id, Random& rng, std::ostream& out) const {
+    if (!alive[id]) return 0;
+
+    int damage = std::max(1, rng.range(attack[id] - 2, attack[id] + 2));
+
+    out << getName(id) << " attacks for " << damage << " damage!\n";
+    return damage;
+}
+
+void EnemyStore::takeDamage(EnemyId id, int damage, std::ostream& out) {
+    int actualDamage = std::max(1, damage - defense[id]);
+    if (health[id] == maxHealth[id]) {
+        hurt.push_back(id);
+    }
+    health[id] = std::max(0, health[id] - actualDamage);
+
+    out << getName(id) << " takes " << actualDamage << " damage. ";
+
+    if (health[id] <= 0) {
+        kill(id);
+        out << getName(id) << " is defeated!\n";
+    } else {
+        out << "Health: " << health[id] << "/" << maxHealth[id] << '\n';
+    }
+}
+
+void EnemyStore::showStatus(EnemyId id, std::ostream& out) const {
+    out << getName(id) << " (" << getTemplate(id).getTypeString() << ")\n";
+    out << "Health: " << health[id] << "/" << maxHealth[id] << '\n';
+    out << "Attack: " << attack[id] << " | Defense: " << defense[id] << '\n';
+}
+
+void EnemyStore::saveState(SnapshotWriter& writer) const {
+    writer.write(static_cast<uint32_t>(templates.size()));
+    for (const auto& spec : templates) {
+        writer.writeString(spec.getName());
+        writer.write(static_cast<uint8_t>(spec.getType()));
+        writer.write<int32_t>(spec.getHealth());
+        writer.write<int32_t>(spec.getAttack());
+        writer.write<int32_t>(spec.getDefense());
+        writer.write<int32_t>(spec.getGoldReward());
+    }
+
+    writer.writeArray(health);
+    writer.writeArray(maxHealth);
+    writer.writeArray(attack);
+    writer.writeArray(defense);
+    writer.writeArray(templateOf);
+    writer.writeArray(room);
+    writer.writeArray(alive);
+    writer.writeArray(roaming);
+    writer.writeArray(nextInRoom);
+    writer.writeArray(prevInRoom);
+    writer.writeArray(roomHead);
+    writer.writeArray(roomTail);
+    writer.writeArray(unscheduled);
+    writer.writeArray(freeIds);
+}
+
+void EnemyStore::loadState(SnapshotReader& reader, size_t roomCount) {
+    templates.clear();
+    templateIds.clear();
+    uint32_t templateCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < templateCount; ++i) {
+        std::string name(reader.readString());
+        uint8_t type = reader.read<uint8_t>();
+        if (type > static_cast<uint8_t>(Enemy::Type::BOSS)) SnapshotReader::fail("save has an unknown enemy type");
+        int32_t baseHealth = reader.read<int32_t>();
+        int32_t baseAttack = reader.read<int32_t>();
+        int32_t baseDefense = reader.read<int32_t>();
+        int32_t goldReward = reader.read<int32_t>();
+        internTemplate(Enemy(name, static_cast<Enemy::Type>(type), baseHealth, baseAttack, baseDefense, goldReward));
+    }
+
+    reader.readArray(health);
+    reader.readArray(maxHealth);
+    reader.readArray(attack);
+    reader.readArray(defense);
+    reader.readArray(templateOf);
+    reader.readArray(room);
+    reader.readArray(alive);
+    reader.readArray(roaming);
+    reader.readArray(nextInRoom);
+    reader.readArray(prevInRoom);
+    reader.readArray(roomHead);
+    reader.readArray(roomTail);
+    reader.readArray(unscheduled);
+    reader.readArray(freeIds);
+
+    // Everything indexes everything else, so check the shape before trusting it
+    size_t count = health.size();
+    bool consistent = maxHealth.size() == count && attack.size() == count && defense.size() == count &&
+                      templateOf.size() == count && room.size() == count && alive.size() == count &&
+                      roaming.size() == count && nextInRoom.size() == count && prevInRoom.size() == count &&
+                      roomHead.size() <= roomCount && roomTail.size() == roomHead.size();
+    for (size_t i = 0; consistent && i < count; ++i) {
+        consistent = templateOf[i] < templates.size() &&
+                     (room[i] == NO_ROOM || room[i] < roomHead.size()) &&
+                     (nextInRoom[i] == NO_ENEMY || nextInRoom[i] < count) &&
+                     (prevInRoom[i] == NO_ENEMY || prevInRoom[i] < count);
+    }
+    for (size_t r = 0; consistent && r < roomHead.size(); ++r) {
+        consistent = (roomHead[r] == NO_ENEMY || roomHead[r] < count) &&
+                     (roomTail[r] == NO_ENEMY || roomTail[r] < count);
+    }
+    for (size_t i = 0; consistent && i < unscheduled.size(); ++i) {
+        consistent = unscheduled[i] < count;
+    }
+    for (size_t i = 0; consistent && i < freeIds.size(); ++i) {
+        consistent = freeIds[i] < count && !alive[freeIds[i]];
+    }
+    if (!consistent) {
+        SnapshotReader::fail("save has inconsistent enemy data");
+    }
+
+    hurt.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (alive[i] && health[i] < maxHealth[i]) {
+            hurt.push_back(static_cast<EnemyId>(i));
+        }
+    }
+}
+
+void EnemyStore::heal(RoomId playerRoom) {
+    // The hurt heal while the player is elsewhere, and leave the list once
+    // they are whole
+    size_t kept = 0;
+    for (EnemyId id : hurt) {
+        if (room[id] != playerRoom) {
+            health[id]++;
+        }
+        if (health[id] < maxHealth[id]) {
+            hurt[kept++] = id;
+        }
+    }
+    hurt.resize(kept);
+}
+
+bool EnemyStore::needsHealing(RoomId playerRoom) const {
+    for (EnemyId id : hurt) {
+        if (alive[id] && room[id] != playerRoom) return true;
+    }
+    return false;
+}
+
+void EnemyStore::takeNewRoamers(std::vector<EnemyId>& roamers) {
+    std::sort(unscheduled.begin(), unscheduled.end());
+    for (EnemyId id : unscheduled) {
+        if (alive[id]) {
+            roamers.push_back(id);
+        } else {
+            release(id);
+        }
+    }
+    unscheduled.clear();
+}
+
+bool EnemyStore::wander(EnemyId id, const ExitTable& exits, Random& rng, RoomId playerRoom) {
+    if (!alive[id]) {
+        release(id);
+        return false;
+    }
+    if (room[id] != playerRoom) {
+        RoomId next = exits[room[id]][rng.next() & 3u];
+        if (next < exits.size() && next != playerRoom) {
+            moveTo(id, next);
+        }
+    }
+    return true;
+}
+
+uint64_t EnemyStore::hashState() const {
+    uint64_t hash = hashMix(0, size());
+    for (size_t i = 0; i < size(); ++i) {
+        // Dead enemies all look alike
+        hash = alive[i] ? hashMix(hash, (uint64_t(room[i]) << 32) | uint32_t(health[i])) : hashMix(hash, 0);
+    }
+    return hash;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Enemy.h"
+#include "ExitTable.h"
+#include "Random.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <ostream>
+#include <cstdint>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+using EnemyId = uint32_t;
+const EnemyId NO_ENEMY = UINT32_MAX;
+
+// Every live enemy in a world, kept as structure-of-arrays. Names and types
+// come from a small table of Enemy templates. Alive enemies are threaded
+// onto a per-room list, so "who is in this room" never scans the whole
+// store. The list heads only grow as far as the highest room an enemy has
+// been in, so a huge world with few enemies about costs little.
+//
+// A turn only touches the enemies with something to do: the hurt ones,
+// which heal, and the wanderers whose next move falls due on the world's
+// timing wheel. The rest of the store, however large, is left alone.
+//
+// Dead enemies' ids go on a free list and are handed out again by the next
+// spawn, so a long session that fights encounter after encounter keeps a
+// store the size of its busiest moment rather than of its whole history.
+class EnemyStore {
+private:
+    // Per-enemy columns, indexed by EnemyId
+    std::vector<int32_t> health;
+    std::vector<int32_t> maxHealth;
+    std::vector<int32_t> attack;
+    std::vector<int32_t> defense;
+    std::vector<uint32_t> templateOf;
+    std::vector<RoomId> room;
+    std::vector<uint8_t> alive;
+    std::vector<uint8_t> roaming;
+    std::vector<EnemyId> nextInRoom;
+    std::vector<EnemyId> prevInRoom;
+
+    // Per-room list heads, indexed by RoomId; rooms past the end have none
+    std::vector<EnemyId> roomHead;
+    std::vector<EnemyId> roomTail;
+
+    // Alive enemies below full health, in no particular order
+    std::vector<EnemyId> hurt;
+    // Wanderers spawned since takeNewRoamers() last ran, which have no
+    // move on the wheel yet
+    std::vector<EnemyId> unscheduled;
+    // Dead ids ready for reuse. A dead wanderer joins only once its last
+    // move falls due, so the wheel never holds an id that has come back.
+    std::vector<EnemyId> freeIds;
+
+    // Name, type and gold reward shared by every enemy of a template
+    std::vector<Enemy> templates;
+    std::unordered_map<std::string, uint32_t> templateIds;
+
+    uint32_t internTemplate(const Enemy& spec);
+    EnemyId add(const Enemy& spec, bool roams);
+    void link(EnemyId id, RoomId target, bool first = false);
+    void unlink(EnemyId id);
+    void release(EnemyId id);
+
+public:
+    void reserve(size_t enemyCount);
+    void clear();
+
+    // Spawns a fresh copy of spec in a room; roaming enemies wander (see wander())
+    EnemyId spawn(const Enemy& spec, RoomId target, bool roams = false);
+    // Spawns ahead of the enemies already in the room: a room's own enemies
+    // are listed before any that wandered in before they spawned
+    EnemyId spawnFirst(const Enemy& spec, RoomId target, bool roams = false);
+    void kill(EnemyId id);
+    void moveTo(EnemyId id, RoomId target);
+
+    // Room queries
+    EnemyId firstInRoom(RoomId id) const { return id < roomHead.size() ? roomHead[id] : NO_ENEMY; }
+    EnemyId nextEnemy(EnemyId id) const { return nextInRoom[id]; }
+    bool hasEnemies(RoomId id) const { return firstInRoom(id) != NO_ENEMY; }
+    // Enemies in a room, counting no further than limit
+    size_t countInRoom(RoomId id, size_t limit) const;
+
+    // Per-enemy state. Ids of dead enemies are reused by later spawns.
+    size_t size() const { return health.size(); }
+    bool isAlive(EnemyId id) const { return alive[id] != 0; }
+    bool isRoaming(EnemyId id) const { return roaming[id] != 0; }
+    RoomId getRoom(EnemyId id) const { return room[id]; }
+    int getHealth(EnemyId id) const { return health[id]; }
+    int getMaxHealth(EnemyId id) const { return maxHealth[id]; }
+    int getAttack(EnemyId id) const { return attack[id]; }
+    int getDefense(EnemyId id) const { return defense[id]; }
+    const Enemy& getTemplate(EnemyId id) const { return templates[templateOf[id]]; }
+    const std::string& getName(EnemyId id) const { return getTemplate(id).getName(); }
+    Enemy::Type getType(EnemyId id) const { return getTemplate(id).getType(); }
+    int getGoldReward(EnemyId id) const { return getTemplate(id).getGoldReward(); }
+
+    // Combat
+    int performAttack(EnemyId id, Random& rng, std::ostream& out) const;
+    void takeDamage(EnemyId id, int damage, std::ostream& out);
+    void showStatus(EnemyId id, std::ostream& out) const;
+
+    // Save games: every column plus the enemy templates in use. roomCount
+    // is the size of the world being loaded into.
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader, size_t roomCount);
+    uint64_t hashState() const;
+
+    // One world turn: enemies away from the player regenerate 1 health
+    void heal(RoomId playerRoom);
+    // Whether heal() would do anything: some enemy away from the player is hurt
+    bool needsHealing(RoomId playerRoom) const;
+
+    // Roaming. Every wanderer has one move waiting on the world's timing
+    // wheel, drawn with moveDelay() so that it moves with a 1 in 4 chance a
+    // turn. takeNewRoamers() hands over the ones spawned since it last
+    // ran, in id order, to get their first. When a move falls due,
+    // wander() takes a random exit, as long as it doesn't lead into or out
+    // of the player's room, so nothing changes under the player's feet;
+    // it returns false if the wanderer has died since, which frees its id.
+    static uint32_t moveDelay(Random& rng);
+    bool hasNewRoamers() const { return !unscheduled.empty(); }
+    void takeNewRoamers(std::vector<EnemyId>& roamers);
+    bool wander(EnemyId id, const ExitTable& exits, Random& rng, RoomId playerRoom);
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "Direction.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// A world's exits: the table the content was built with, which may be part
+// of a read-only world image, plus the few rows changed since (passages
+// opened by keys). The base table is never copied, so a world of any size
+// starts with its exits in place. Copies share the changed rows until one
+// side changes another, like the rest of World. A bit per room, kept only
+// up to the highest changed one, marks the changed rows, so lookups of
+// unchanged rows skip the map.
+class ExitTable {
+private:
+    using Rows = std::unordered_map<RoomId, ExitRow>;
+    struct Changes {
+        std::vector<uint64_t> marked;
+        Rows rows;
+    };
+
+    const ExitRow* base;
+    size_t count;
+    std::shared_ptr<Changes> changes;
+    // changes->marked, cached here so unchanged rows cost one bit test
+    const uint64_t* marked;
+    size_t markedWords;
+
+    void cacheMarked() {
+        marked = changes->marked.data();
+        markedWords = changes->marked.size();
+    }
+
+public:
+    ExitTable() : ExitTable(nullptr, 0) {}
+    ExitTable(const ExitRow* base, size_t count)
+        : base(base), count(count), changes(std::make_shared<Changes>()), marked(nullptr), markedWords(0) {}
+
+    size_t size() const { return count; }
+
+    const ExitRow& operator[](RoomId id) const {
+        size_t word = id / 64;
+        if (word < markedWords && (marked[word] >> (id % 64) & 1)) {
+            return changes->rows.find(id)->second;
+        }
+        return base[id];
+    }
+
+    void set(RoomId from, Direction direction, RoomId to) {
+        if (changes.use_count() > 1) {
+            changes = std::make_shared<Changes>(*changes);
+        }
+        size_t word = from / 64;
+        if (word >= changes->marked.size()) {
+            changes->marked.resize(word + 1, 0);
+        }
+        changes->marked[word] |= uint64_t(1) << (from % 64);
+        cacheMarked();
+        ExitRow& row = changes->rows.emplace(from, base[from]).first->second;
+        row[static_cast<size_t>(direction)] = to;
+    }
+
+    // Rows that differ from the base table, in no particular order
+    const Rows& changedRows() const { return changes->rows; }
+};
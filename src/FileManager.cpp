@@ -0,0 +1,691 @@
+#include "FileManager.h"
+#include "WorldImage.h"
+#include <fstream>
+#include <deque>
+#include <algorithm>
+#include <numeric>
+#include <cctype>
+#include <stdexcept>
+#include <charconv>
+#include <optional>
+#include <cstring>
+
+namespace {
+
+// Walks a data file one line at a time. Keys and values are views into the
+// file's buffer; nothing is copied until a record is stored.
+class DataReader {
+private:
+    std::string_view text;
+    std::string file;
+    size_t pos;
+    int lineNumber;
+
+public:
+    enum class Entry { SECTION, FIELD, END };
+
+    DataReader(std::string_view text, std::string file)
+        : text(text), file(std::move(file)), pos(0), lineNumber(0) {}
+
+    // Advances to the next "[section]" (name in key) or "key=value" line,
+    // skipping blank lines and '#' comments
+    Entry next(std::string_view& key, std::string_view& value);
+    int line() const { return lineNumber; }
+    std::string_view contents() const { return text; }
+
+    [[noreturn]] void fail(const std::string& message) const { failAt(lineNumber, message); }
+    [[noreturn]] void failAt(int line, const std::string& message) const {
+        throw std::runtime_error(file + ":" + std::to_string(line) + ": " + message);
+    }
+};
+
+std::string_view trim(std::string_view text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) return {};
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+DataReader::Entry DataReader::next(std::string_view& key, std::string_view& value) {
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view line = trim(text.substr(pos, end - pos));
+        pos = end + 1;
+        lineNumber++;
+
+        if (line.empty() || line.front() == '#') continue;
+
+        if (line.front() == '[') {
+            if (line.back() != ']') fail("unterminated section header");
+            key = trim(line.substr(1, line.size() - 2));
+            if (key.empty()) fail("empty section name");
+            return Entry::SECTION;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string_view::npos) fail("expected 'key=value' or '[section]'");
+        key = trim(line.substr(0, equals));
+        value = trim(line.substr(equals + 1));
+        if (key.empty()) fail("missing key before '='");
+        return Entry::FIELD;
+    }
+    return Entry::END;
+}
+
+// Upper bound on the number of sections, for reserving up front
+size_t countSections(std::string_view text) {
+    size_t count = 0;
+    for (size_t pos = text.find('['); pos != std::string_view::npos; pos = text.find('[', pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+std::string quoted(std::string_view text) {
+    std::string result = "'";
+    result.append(text);
+    result += '\'';
+    return result;
+}
+
+int parseNumber(const DataReader& reader, std::string_view key, std::string_view value) {
+    int number = 0;
+    auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (value.empty() || result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+        reader.fail("expected a number for " + quoted(key) + ", got " + quoted(value));
+    }
+    return number;
+}
+
+// Calls f on each trimmed, non-empty entry of a comma separated list
+template <typename F>
+void forEachListEntry(std::string_view list, F f) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view entry = trim(list.substr(0, comma));
+        if (!entry.empty()) f(entry);
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+}
+
+// Section names seen so far, viewing the file buffers
+using NameIndex = std::unordered_map<std::string_view, uint32_t>;
+
+void addName(const DataReader& reader, NameIndex& names, std::string_view name, size_t index, const char* what) {
+    if (!names.emplace(name, static_cast<uint32_t>(index)).second) {
+        reader.fail(std::string("duplicate ") + what + " " + quoted(name));
+    }
+}
+
+Item::Type parseItemType(const DataReader& reader, std::string_view value) {
+    if (value == "weapon") return Item::Type::WEAPON;
+    if (value == "potion") return Item::Type::POTION;
+    if (value == "key") return Item::Type::KEY;
+    if (value == "treasure") return Item::Type::TREASURE;
+    if (value == "quest_item") return Item::Type::QUEST_ITEM;
+    reader.fail("unknown item type " + quoted(value));
+}
+
+Enemy::Type parseEnemyType(const DataReader& reader, std::string_view value) {
+    if (value == "goblin") return Enemy::Type::GOBLIN;
+    if (value == "wolf") return Enemy::Type::WOLF;
+    if (value == "skeleton") return Enemy::Type::SKELETON;
+    if (value == "ghost") return Enemy::Type::GHOST;
+    if (value == "boss") return Enemy::Type::BOSS;
+    reader.fail("unknown enemy type " + quoted(value));
+}
+
+Room::HazardType parseHazard(const DataReader& reader, std::string_view value) {
+    if (value == "none") return Room::HazardType::NONE;
+    if (value == "poison") return Room::HazardType::POISON;
+    if (value == "cursed") return Room::HazardType::CURSED;
+    if (value == "cold") return Room::HazardType::COLD;
+    if (value == "hot") return Room::HazardType::HOT;
+    reader.fail("unknown hazard " + quoted(value));
+}
+
+bool parseYesNo(const DataReader& reader, std::string_view key, std::string_view value) {
+    if (value == "yes") return true;
+    if (value == "no") return false;
+    reader.fail("expected yes or no for " + quoted(key) + ", got " + quoted(value));
+}
+
+void parseItems(DataReader reader, GameData& data, NameIndex& names) {
+    std::string_view name, description, key, value;
+    std::optional<Item::Type> type;
+    int worth = 0, effect = 0, line = 0;
+
+    auto finish = [&]() {
+        if (name.empty()) return;
+        if (!type) reader.failAt(line, "item " + quoted(name) + " has no type");
+        data.items.emplace_back(std::string(name), std::string(description), *type, worth, effect);
+        data.items.back().setId(static_cast<ItemId>(data.items.size() - 1));
+    };
+
+    for (;;) {
+        auto entry = reader.next(key, value);
+        if (entry != DataReader::Entry::FIELD) {
+            finish();
+            if (entry == DataReader::Entry::END) break;
+
+            addName(reader, names, key, data.items.size(), "item");
+            name = key;
+            description = {};
+            type.reset();
+            worth = effect = 0;
+            line = reader.line();
+            continue;
+        }
+
+        if (name.empty()) reader.fail(quoted(key) + " outside of an [item] section");
+        if (key == "description") description = value;
+        else if (key == "type") type = parseItemType(reader, value);
+        else if (key == "value") worth = parseNumber(reader, key, value);
+        else if (key == "effect") effect = parseNumber(reader, key, value);
+        else reader.fail("unknown item key " + quoted(key));
+    }
+}
+
+void parseEnemies(DataReader reader, GameData& data, NameIndex& names) {
+    std::string_view name, key, value;
+    std::optional<Enemy::Type> type;
+    int health = 0, attack = 0, defense = 0, goldReward = 0, line = 0;
+    bool roams = false;
+
+    auto finish = [&]() {
+        if (name.empty()) return;
+        if (!type) reader.failAt(line, "enemy " + quoted(name) + " has no type");
+        if (health <= 0) reader.failAt(line, "enemy " + quoted(name) + " needs positive health");
+        if (*type != Enemy::Type::BOSS) {
+            data.encounters.push_back(static_cast<uint32_t>(data.enemies.size()));
+        }
+        if (roams && *type == Enemy::Type::BOSS) reader.failAt(line, "boss " + quoted(name) + " can't roam");
+        data.enemies.emplace_back(std::string(name), *type, health, attack, defense, goldReward, roams);
+    };
+
+    for (;;) {
+        auto entry = reader.next(key, value);
+        if (entry != DataReader::Entry::FIELD) {
+            finish();
+            if (entry == DataReader::Entry::END) break;
+
+            addName(reader, names, key, data.enemies.size(), "enemy");
+            name = key;
+            type.reset();
+            health = attack = defense = goldReward = 0;
+            roams = false;
+            line = reader.line();
+            continue;
+        }
+
+        if (name.empty()) reader.fail(quoted(key) + " outside of an [enemy] section");
+        if (key == "type") type = parseEnemyType(reader, value);
+        else if (key == "health") health = parseNumber(reader, key, value);
+        else if (key == "attack") attack = parseNumber(reader, key, value);
+        else if (key == "defense") defense = parseNumber(reader, key, value);
+        else if (key == "gold_reward") goldReward = parseNumber(reader, key, value);
+        else if (key == "roams") roams = parseYesNo(reader, key, value);
+        else reader.fail("unknown enemy key " + quoted(key));
+    }
+}
+
+void parseRooms(DataReader reader, GameData& data, const NameIndex& items, const NameIndex& enemies, NameIndex& names) {
+    // Exits may point at rooms further down the file, so resolve them at the end
+    struct PendingExit {
+        uint32_t room;
+        Direction direction;
+        std::string_view target;
+        int line;
+    };
+    std::vector<PendingExit> pendingExits;
+    std::string_view key, value;
+    int line = 0;
+
+    size_t expected = countSections(reader.contents());
+    data.rooms.reserve(expected);
+    data.exits.reserve(expected);
+    names.reserve(expected);
+    pendingExits.reserve(expected * 2);
+
+    auto finish = [&]() {
+        if (!data.rooms.empty() && data.rooms.back().name.empty()) {
+            reader.failAt(line, "room " + quoted(data.rooms.back().id) + " has no name");
+        }
+    };
+
+    for (;;) {
+        auto entry = reader.next(key, value);
+        if (entry != DataReader::Entry::FIELD) {
+            finish();
+            if (entry == DataReader::Entry::END) break;
+
+            addName(reader, names, key, data.rooms.size(), "room");
+            GameData::RoomData room{};
+            room.id = key;
+            room.hazard = Room::HazardType::NONE;
+            room.firstItem = static_cast<uint32_t>(data.roomItems.size());
+            room.firstEnemy = static_cast<uint32_t>(data.roomEnemies.size());
+            data.rooms.push_back(room);
+            data.exits.emplace_back().fill(NO_ROOM);
+            line = reader.line();
+            continue;
+        }
+
+        if (data.rooms.empty()) reader.fail(quoted(key) + " outside of a [room] section");
+        GameData::RoomData& room = data.rooms.back();
+        uint32_t roomIndex = static_cast<uint32_t>(data.rooms.size() - 1);
+
+        if (key == "name") {
+            room.name = value;
+        } else if (key == "description") {
+            room.description = value;
+        } else if (key == "exits") {
+            forEachListEntry(value, [&](std::string_view exit) {
+                size_t colon = exit.find(':');
+                if (colon == std::string_view::npos) reader.fail("exit " + quoted(exit) + " is not direction:room");
+                Direction direction = parseDirection(trim(exit.substr(0, colon)));
+                if (direction == Direction::NONE) reader.fail("unknown direction in exit " + quoted(exit));
+                pendingExits.push_back({roomIndex, direction, trim(exit.substr(colon + 1)), reader.line()});
+            });
+        } else if (key == "hazard") {
+            room.hazard = parseHazard(reader, value);
+        } else if (key == "special_event") {
+            room.specialEvent = value;
+        } else if (key == "items") {
+            forEachListEntry(value, [&](std::string_view item) {
+                auto it = items.find(item);
+                if (it == items.end()) reader.fail("unknown item " + quoted(item));
+                data.roomItems.push_back(it->second);
+                room.itemCount++;
+            });
+        } else if (key == "enemies") {
+            forEachListEntry(value, [&](std::string_view enemy) {
+                auto it = enemies.find(enemy);
+                if (it == enemies.end()) reader.fail("unknown enemy " + quoted(enemy));
+                data.roomEnemies.push_back(it->second);
+                room.enemyCount++;
+            });
+        } else if (key == "encounter_chance") {
+            room.encounterChance = parseNumber(reader, key, value);
+            if (room.encounterChance < 0 || room.encounterChance > 100) {
+                reader.fail("encounter_chance must be between 0 and 100");
+            }
+        } else {
+            reader.fail("unknown room key " + quoted(key));
+        }
+    }
+
+    if (data.rooms.empty()) reader.failAt(reader.line(), "no rooms defined");
+
+    for (const auto& exit : pendingExits) {
+        auto it = names.find(exit.target);
+        if (it == names.end()) reader.failAt(exit.line, "exit leads to unknown room " + quoted(exit.target));
+        data.exits[exit.room][static_cast<size_t>(exit.direction)] = it->second;
+    }
+}
+
+void parseDialogues(DataReader reader, GameData& data, const NameIndex& items) {
+    std::string_view id, triggerItem, trigger, text, key, value;
+    int line = 0;
+
+    auto finish = [&]() {
+        if (id.empty()) return;
+        if (text.empty()) reader.failAt(line, "memory " + quoted(id) + " has no memory_text");
+        MemoryId memory = static_cast<MemoryId>(data.memories.size());
+        data.memories.push_back(text);
+
+        // Defeating the boss is not tied to an item
+        if (!trigger.empty()) {
+            if (trigger != "victory") reader.failAt(line, "unknown memory trigger " + quoted(trigger));
+            if (!triggerItem.empty()) reader.failAt(line, "memory " + quoted(id) + " has both trigger and trigger_item");
+            if (data.victoryMemory != NO_MEMORY) reader.failAt(line, "only one memory can have trigger=victory");
+            data.victoryMemory = memory;
+            return;
+        }
+
+        if (triggerItem.empty()) reader.failAt(line, "memory " + quoted(id) + " has no trigger_item");
+        auto item = items.find(triggerItem);
+        if (item == items.end()) {
+            reader.failAt(line, "memory " + quoted(id) + " is triggered by unknown item " + quoted(triggerItem));
+        }
+        TriggerRule rule{TriggerEvent::TAKE, item->second, NO_ROOM, {}, {}, {}, memory};
+        rule.opens.fill(NO_ROOM);
+        if (!data.triggers.add(rule)) {
+            reader.failAt(line, "item " + quoted(triggerItem) + " already triggers a memory");
+        }
+    };
+
+    for (;;) {
+        auto entry = reader.next(key, value);
+        if (entry != DataReader::Entry::FIELD) {
+            finish();
+            if (entry == DataReader::Entry::END) break;
+
+            addName(reader, data.memoryIds, key, data.memories.size(), "memory");
+            id = key;
+            triggerItem = trigger = text = {};
+            line = reader.line();
+            continue;
+        }
+
+        if (id.empty()) reader.fail(quoted(key) + " outside of a [memory] section");
+        if (key == "trigger_item") triggerItem = value;
+        else if (key == "trigger") trigger = value;
+        else if (key == "memory_text") text = value;
+        else reader.fail("unknown memory key " + quoted(key));
+    }
+
+    // Without it the game can't be won
+    if (data.victoryMemory == NO_MEMORY) reader.fail("no memory has trigger=victory");
+}
+
+TriggerEvent parseTriggerEvent(const DataReader& reader, std::string_view value) {
+    if (value == "take") return TriggerEvent::TAKE;
+    if (value == "use") return TriggerEvent::USE;
+    if (value == "enter") return TriggerEvent::ENTER;
+    reader.fail("unknown trigger event " + quoted(value));
+}
+
+void parseTriggers(DataReader reader, GameData& data, const NameIndex& rooms) {
+    std::string_view name, key, value;
+    TriggerRule rule{};
+    bool hasEvent = false;
+    NameIndex names;
+    int line = 0;
+
+    auto finish = [&]() {
+        if (name.empty()) return;
+        if (!hasEvent) reader.failAt(line, "trigger " + quoted(name) + " has no 'on'");
+        if ((rule.event == TriggerEvent::ENTER) != (rule.item == NO_ITEM)) {
+            reader.failAt(line, "trigger " + quoted(name) + (rule.item == NO_ITEM ? " needs an item" : " can't have an item"));
+        }
+        if (rule.event == TriggerEvent::USE && data.items[rule.item].getType() == Item::Type::POTION) {
+            reader.failAt(line, "trigger " + quoted(name) + " is for a potion, which using drinks");
+        }
+        bool changesRoom = !rule.specialEvent.empty() ||
+                           std::any_of(rule.opens.begin(), rule.opens.end(), [](RoomId to) { return to != NO_ROOM; });
+        if (rule.room == NO_ROOM && (changesRoom || rule.event == TriggerEvent::ENTER)) {
+            reader.failAt(line, "trigger " + quoted(name) + " needs a room");
+        }
+        if (!data.triggers.add(rule)) {
+            reader.failAt(line, "trigger " + quoted(name) + " repeats an earlier one's on, item and room");
+        }
+    };
+
+    for (;;) {
+        auto entry = reader.next(key, value);
+        if (entry != DataReader::Entry::FIELD) {
+            finish();
+            if (entry == DataReader::Entry::END) break;
+
+            addName(reader, names, key, names.size(), "trigger");
+            name = key;
+            hasEvent = false;
+            rule = TriggerRule{};
+            rule.item = NO_ITEM;
+            rule.room = NO_ROOM;
+            rule.opens.fill(NO_ROOM);
+            rule.memory = NO_MEMORY;
+            line = reader.line();
+            continue;
+        }
+
+        if (name.empty()) reader.fail(quoted(key) + " outside of a [trigger] section");
+        if (key == "on") {
+            rule.event = parseTriggerEvent(reader, value);
+            hasEvent = true;
+        } else if (key == "item") {
+            auto it = data.itemIds.find(value);
+            if (it == data.itemIds.end()) reader.fail("unknown item " + quoted(value));
+            rule.item = it->second;
+        } else if (key == "room") {
+            auto it = rooms.find(value);
+            if (it == rooms.end()) reader.fail("unknown room " + quoted(value));
+            rule.room = it->second;
+        } else if (key == "message") {
+            rule.message = value;
+        } else if (key == "special_event") {
+            rule.specialEvent = value;
+        } else if (key == "opens") {
+            forEachListEntry(value, [&](std::string_view exit) {
+                size_t colon = exit.find(':');
+                if (colon == std::string_view::npos) reader.fail("exit " + quoted(exit) + " is not direction:room");
+                Direction direction = parseDirection(trim(exit.substr(0, colon)));
+                if (direction == Direction::NONE) reader.fail("unknown direction in exit " + quoted(exit));
+                auto it = rooms.find(trim(exit.substr(colon + 1)));
+                if (it == rooms.end()) reader.fail("exit leads to unknown room " + quoted(trim(exit.substr(colon + 1))));
+                rule.opens[static_cast<size_t>(direction)] = it->second;
+            });
+        } else if (key == "memory") {
+            auto it = data.memoryIds.find(value);
+            if (it == data.memoryIds.end()) reader.fail("unknown memory " + quoted(value));
+            rule.memory = it->second;
+        } else {
+            reader.fail("unknown trigger key " + quoted(key));
+        }
+    }
+}
+
+bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(&contents[0], static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file);
+}
+
+std::string pathOf(const std::string& directory, const char* name) {
+    return directory.empty() ? name : directory + "/" + name;
+}
+
+// Reads a file the content can't do without
+void readRequired(const std::string& directory, const char* name, std::string& contents) {
+    if (!readFile(pathOf(directory, name), contents)) {
+        throw std::runtime_error("Missing data file: " + pathOf(directory, name));
+    }
+}
+
+// FNV-1a style hash taken a word at a time; the sizes keep content from
+// shifting between files unnoticed
+uint64_t fingerprintOf(const std::deque<std::string>& sources) {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto& source : sources) {
+        hash = (hash ^ source.size()) * prime;
+
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= source.size(); i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, source.data() + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < source.size(); ++i) {
+            hash = (hash ^ static_cast<unsigned char>(source[i])) * prime;
+        }
+    }
+    return hash;
+}
+
+// The default world: data/*.txt, embedded at build time (see the Makefile)
+#include "BuiltinData.inc"
+
+char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// Orders names as their lowercased forms would be ordered
+int compareLowercase(std::string_view a, std::string_view b) {
+    size_t length = std::min(a.size(), b.size());
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char x = lower(a[i]), y = lower(b[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+}
+
+void buildIndexes(GameData& data) {
+    const size_t count = data.rooms.size();
+
+    // Generated ids come out in order already
+    auto idLess = [&data](RoomId a, RoomId b) { return data.rooms[a].id < data.rooms[b].id; };
+    data.roomsById.resize(count);
+    std::iota(data.roomsById.begin(), data.roomsById.end(), RoomId(0));
+    if (!std::is_sorted(data.roomsById.begin(), data.roomsById.end(), idLess)) {
+        std::sort(data.roomsById.begin(), data.roomsById.end(), idLess);
+    }
+
+    // Big worlds have millions of rooms but few names, so the names are
+    // sorted once each and the rooms counting-sorted by them, which keeps
+    // rooms of the same name in index order
+    std::unordered_map<std::string_view, uint32_t> groupIds;
+    std::vector<std::string_view> groupNames;
+    std::vector<uint32_t> groupOf(count);
+    for (size_t room = 0; room < count; ++room) {
+        auto inserted = groupIds.emplace(data.rooms[room].name, static_cast<uint32_t>(groupNames.size()));
+        if (inserted.second) groupNames.push_back(data.rooms[room].name);
+        groupOf[room] = inserted.first->second;
+    }
+
+    std::vector<uint32_t> order(groupNames.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&groupNames](uint32_t a, uint32_t b) {
+        return compareLowercase(groupNames[a], groupNames[b]) < 0;
+    });
+    // Names that differ only in case share a rank
+    std::vector<uint32_t> rank(groupNames.size());
+    uint32_t ranks = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && compareLowercase(groupNames[order[i - 1]], groupNames[order[i]]) != 0) ++ranks;
+        rank[order[i]] = ranks;
+    }
+
+    std::vector<uint32_t> start(ranks + 2, 0);
+    for (size_t room = 0; room < count; ++room) {
+        start[rank[groupOf[room]] + 1]++;
+    }
+    for (size_t r = 1; r < start.size(); ++r) {
+        start[r] += start[r - 1];
+    }
+    data.roomsByName.resize(count);
+    for (size_t room = 0; room < count; ++room) {
+        data.roomsByName[start[rank[groupOf[room]]]++] = static_cast<RoomId>(room);
+    }
+}
+
+} // namespace
+
+ItemId GameData::itemId(std::string_view name) const {
+    auto it = itemIds.find(name);
+    if (it == itemIds.end()) {
+        throw std::runtime_error("Item is not part of the game data: " + std::string(name));
+    }
+    return it->second;
+}
+
+size_t GameData::roomCount() const {
+    return image ? image->roomCount() : rooms.size();
+}
+
+GameData::RoomData GameData::room(RoomId id) const {
+    return image ? image->room(id) : rooms[id];
+}
+
+const ExitRow* GameData::exitTable() const {
+    return image ? image->exitTable() : exits.data();
+}
+
+uint32_t GameData::roomItem(uint32_t index) const {
+    return image ? image->roomItem(index) : roomItems[index];
+}
+
+uint32_t GameData::roomEnemy(uint32_t index) const {
+    return image ? image->roomEnemy(index) : roomEnemies[index];
+}
+
+RoomId GameData::findRoom(std::string_view id) const {
+    auto idOf = [this](RoomId room) { return image ? image->roomIdOf(room) : rooms[room].id; };
+    const RoomId* index = image ? image->roomsById() : roomsById.data();
+    const RoomId* end = index + roomCount();
+    const RoomId* found = std::partition_point(index, end, [&](RoomId room) { return idOf(room) < id; });
+    return found != end && idOf(*found) == id ? *found : NO_ROOM;
+}
+
+RoomId GameData::findRoomByName(std::string_view name) const {
+    auto nameOf = [this](RoomId room) { return image ? image->roomNameOf(room) : rooms[room].name; };
+    const RoomId* index = image ? image->roomsByName() : roomsByName.data();
+    const RoomId* end = index + roomCount();
+    const RoomId* found = std::partition_point(index, end, [&](RoomId room) {
+        return compareLowercase(nameOf(room), name) < 0;
+    });
+    return found != end && compareLowercase(nameOf(*found), name) == 0 ? *found : NO_ROOM;
+}
+
+std::shared_ptr<GameData> FileManager::parseContent(std::string items, std::string enemies,
+                                                    std::string dialogues, const std::string& directory) {
+    // Built in place: the views below must not outlive or move away from sources
+    auto data = std::make_shared<GameData>();
+    std::string_view itemText = data->sources.emplace_back(std::move(items));
+    std::string_view enemyText = data->sources.emplace_back(std::move(enemies));
+    std::string_view dialogueText = data->sources.emplace_back(std::move(dialogues));
+
+    // Rooms refer to items and enemies, memories to items
+    parseItems(DataReader(itemText, pathOf(directory, "items.txt")), *data, data->itemIds);
+    parseEnemies(DataReader(enemyText, pathOf(directory, "enemies.txt")), *data, data->enemyIds);
+    parseDialogues(DataReader(dialogueText, pathOf(directory, "dialogues.txt")), *data, data->itemIds);
+    data->contentTriggers = data->triggers.size();
+    return data;
+}
+
+void FileManager::seal(GameData& data) {
+    buildIndexes(data);
+    data.fingerprint = fingerprintOf(data.sources);
+}
+
+std::shared_ptr<const GameData> FileManager::parse(std::string rooms, std::string items,
+                                                   std::string enemies, std::string dialogues,
+                                                   std::string triggers, const std::string& directory) {
+    auto data = parseContent(std::move(items), std::move(enemies), std::move(dialogues), directory);
+    std::string_view roomText = data->sources.emplace_back(std::move(rooms));
+    std::string_view triggerText = data->sources.emplace_back(std::move(triggers));
+
+    // Triggers refer to rooms
+    NameIndex roomIds;
+    parseRooms(DataReader(roomText, pathOf(directory, "rooms.txt")), *data, data->itemIds, data->enemyIds, roomIds);
+    parseTriggers(DataReader(triggerText, pathOf(directory, "triggers.txt")), *data, roomIds);
+    seal(*data);
+    return data;
+}
+
+std::shared_ptr<GameData> FileManager::loadContent(const std::string& directory) {
+    std::string items, enemies, dialogues;
+    readFile(pathOf(directory, "items.txt"), items);
+    readFile(pathOf(directory, "enemies.txt"), enemies);
+    readRequired(directory, "dialogues.txt", dialogues);
+    return parseContent(std::move(items), std::move(enemies), std::move(dialogues), directory);
+}
+
+std::shared_ptr<const GameData> FileManager::loadDirectory(const std::string& directory) {
+    std::string rooms, items, enemies, dialogues, triggers;
+    readRequired(directory, "rooms.txt", rooms);
+    readFile(pathOf(directory, "items.txt"), items);
+    readFile(pathOf(directory, "enemies.txt"), enemies);
+    readRequired(directory, "dialogues.txt", dialogues);
+    readFile(pathOf(directory, "triggers.txt"), triggers);
+
+    return parse(std::move(rooms), std::move(items), std::move(enemies), std::move(dialogues),
+                 std::move(triggers), directory);
+}
+
+std::shared_ptr<GameData> FileManager::builtinContent() {
+    return parseContent(BUILTIN_ITEMS, BUILTIN_ENEMIES, BUILTIN_DIALOGUES, "");
+}
+
+std::shared_ptr<const GameData> FileManager::builtinData() {
+    static const std::shared_ptr<const GameData> data =
+        parse(BUILTIN_ROOMS, BUILTIN_ITEMS, BUILTIN_ENEMIES, BUILTIN_DIALOGUES, BUILTIN_TRIGGERS);
+    return data;
+}
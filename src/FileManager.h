@@ -0,0 +1,111 @@
+#pragma once
+#include "Item.h"
+#include "Enemy.h"
+#include "Room.h"
+#include "Direction.h"
+#include "FlagSet.h"
+#include "TriggerTable.h"
+#include <array>
+#include <deque>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+class WorldImage;
+
+// Everything needed to build a fresh world, parsed once and shared by every
+// session. Room text views the loaded files instead of being copied, and
+// cross references are resolved to indices at load time, so building a
+// world from it never looks anything up by name.
+//
+// The rooms either live in the tables here or, for a world loaded from a
+// compiled image, in the image; read them through the accessors below,
+// which work for both.
+struct GameData {
+    struct RoomData {
+        std::string_view id;
+        std::string_view name;
+        std::string_view description;
+        std::string_view specialEvent;
+        Room::HazardType hazard;
+        int encounterChance;             // percent chance per arrival
+        uint32_t firstItem, itemCount;   // range of roomItems
+        uint32_t firstEnemy, enemyCount; // range of roomEnemies
+    };
+
+    std::deque<std::string> sources;     // contents the views point into; adding one never moves the rest
+    std::vector<RoomData> rooms;         // the player starts in rooms[0]
+    std::vector<ExitRow> exits;          // by room, indices into rooms
+    std::vector<uint32_t> roomItems;     // indices into items
+    std::vector<uint32_t> roomEnemies;   // indices into enemies
+    std::vector<RoomId> roomsById;       // rooms sorted by id, for lookups
+    std::vector<RoomId> roomsByName;     // rooms sorted by lowercased name, then index
+    std::shared_ptr<const WorldImage> image;  // when set, holds the rooms instead of the tables above
+    std::vector<Item> items;
+    std::unordered_map<std::string_view, uint32_t> itemIds;  // item name -> index into items
+    std::vector<Enemy> enemies;
+    std::unordered_map<std::string_view, uint32_t> enemyIds; // enemy name -> index into enemies
+    std::vector<uint32_t> encounters;    // indices of enemies that roam as random encounters
+    std::vector<std::string_view> memories;   // memory text by MemoryId
+    MemoryId victoryMemory;                   // recovered by defeating the boss
+    std::unordered_map<std::string_view, MemoryId> memoryIds;  // memory name -> MemoryId
+    TriggerTable triggers;               // what taking, using and entering do
+    size_t contentTriggers;              // triggers[0, contentTriggers) come with the content, the rest with the rooms
+    uint64_t fingerprint;                // hash of the sources, so saves only load into the same content
+
+    GameData() : victoryMemory(NO_MEMORY), contentTriggers(0), fingerprint(0) {}
+    
+    // Index of an item by name; throws for items not in this content
+    ItemId itemId(std::string_view name) const;
+
+    // Rooms, wherever they are kept
+    size_t roomCount() const;
+    RoomData room(RoomId id) const;
+    const ExitRow* exitTable() const;
+    uint32_t roomItem(uint32_t index) const;   // entries of roomItems
+    uint32_t roomEnemy(uint32_t index) const;  // entries of roomEnemies
+    RoomId findRoom(std::string_view id) const;
+    // By display name, given in lowercase; the lowest index wins if several
+    // rooms share a name
+    RoomId findRoomByName(std::string_view name) const;
+    GameData(const GameData&) = delete;  // would leave the views pointing at the original
+    GameData& operator=(const GameData&) = delete;
+};
+
+// Loads game content in the formats described in data/README.md. Each file
+// is read in one go and parsed in a single pass over string_views into the
+// buffer; errors are reported as "file:line: message".
+class FileManager {
+public:
+    // Loads rooms.txt, items.txt, enemies.txt, dialogues.txt and
+    // triggers.txt from a directory. rooms.txt and dialogues.txt, which
+    // holds the victory memory, are required; a missing one is reported
+    // as missing.
+    static std::shared_ptr<const GameData> loadDirectory(const std::string& directory);
+
+    // The default world, compiled in
+    static std::shared_ptr<const GameData> builtinData();
+
+    // Parses file contents, which the result keeps; the directory is only
+    // used in error messages
+    static std::shared_ptr<const GameData> parse(std::string rooms, std::string items,
+                                                 std::string enemies, std::string dialogues,
+                                                 std::string triggers, const std::string& directory = "");
+
+    // Everything but the rooms, for worlds whose rooms are built some
+    // other way (see WorldGenerator): items, enemies, memories and the
+    // memories' triggers from a directory's files or the built-in ones.
+    // triggers.txt names rooms, so it is left out. Whoever adds the rooms
+    // adds what they were made from to sources and then calls seal(),
+    // which builds the lookup indexes and the fingerprint.
+    static std::shared_ptr<GameData> loadContent(const std::string& directory);
+    static std::shared_ptr<GameData> builtinContent();
+    static void seal(GameData& data);
+
+private:
+    static std::shared_ptr<GameData> parseContent(std::string items, std::string enemies,
+                                                  std::string dialogues, const std::string& directory);
+};
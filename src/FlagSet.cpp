@@ -0,0 +1,43 @@
+#include "FlagSet.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+
+bool FlagSet::set(FlagId flag) {
+    size_t word = flag / 64;
+    if (word >= words.size()) {
+        words.resize(word + 1, 0);
+    }
+    uint64_t bit = uint64_t(1) << (flag % 64);
+    if (words[word] & bit) return false;
+    words[word] |= bit;
+    return true;
+}
+
+void FlagSet::saveState(SnapshotWriter& writer) const {
+    writer.writeArray(words);
+}
+
+void FlagSet::loadState(SnapshotReader& reader, size_t limit) {
+    std::vector<uint64_t> loaded;
+    reader.readArray(loaded);
+    for (size_t word = 0; word < loaded.size(); ++word) {
+        size_t first = word * 64;
+        if (first + 64 <= limit) continue;
+        // Only the bits below limit may be set
+        uint64_t allowed = first >= limit ? 0 : (uint64_t(1) << (limit - first)) - 1;
+        if (loaded[word] & ~allowed) SnapshotReader::fail("save sets an unknown flag");
+    }
+    words = std::move(loaded);
+}
+
+uint64_t FlagSet::hashState() const {
+    // Trailing empty words, left by growth, do not change the set
+    size_t size = words.size();
+    while (size > 0 && words[size - 1] == 0) --size;
+
+    uint64_t hash = 0;
+    for (size_t word = 0; word < size; ++word) {
+        hash = hashMix(hash, words[word]);
+    }
+    return hash;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Memories and quest flags are interned to small integer ids
+using FlagId = uint32_t;
+const FlagId NO_FLAG = UINT32_MAX;
+
+// Memories are flags in each player's memory FlagSet
+using MemoryId = FlagId;
+const MemoryId NO_MEMORY = NO_FLAG;
+
+// A growable bitset of flags: one bit per id, so testing a flag is a
+// shift and a mask however many there are
+class FlagSet {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    bool test(FlagId flag) const {
+        size_t word = flag / 64;
+        return word < words.size() && (words[word] >> (flag % 64) & 1);
+    }
+
+    // Returns true if the flag was not already set
+    bool set(FlagId flag);
+    void clear() { words.clear(); }
+
+    // limit is one past the largest valid id; loading fails on a save
+    // that sets anything at or beyond it
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader, size_t limit);
+    uint64_t hashState() const;
+};
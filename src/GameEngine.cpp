@@ -1,412 +1,911 @@
 #include "GameEngine.h"
-#include <iostream>
-#include <sstream>
+#include "Snapshot.h"
+#include "StateHash.h"
+#include "Journal.h"
+#include "Metrics.h"
 #include <algorithm>
-#include <random>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
 
-GameEngine::GameEngine() : gameRunning(false), gameWon(false), turnsPlayed(0), finalBossDefeated(false) {}
+namespace {
 
-void GameEngine::startGame() {
-    std::cout << "========================================" << std::endl;
-    std::cout << "   Echoes of the Forgotten Realm" << std::endl;
-    std::cout << "========================================" << std::endl;
-    std::cout << "\nYou awaken in a ruined world with no memory..." << std::endl;
-    std::cout << "Explore, survive, and uncover your forgotten past.\n" << std::endl;
+// "EFRS" followed by the format version
+const uint32_t SAVE_MAGIC = 0x53524645;
+const uint32_t SAVE_VERSION = 10;
+
+// Random encounters stop turning up in a room holding this many enemies
+const size_t ENCOUNTER_CAP = 2;
+
+Metrics::Handler handlerOf(Verb verb) {
+    switch (verb) {
+        case Verb::MOVE:
+        case Verb::NORTH:
+        case Verb::SOUTH:
+        case Verb::EAST:
+        case Verb::WEST:
+            return Metrics::Handler::MOVE;
+        case Verb::TRAVEL: return Metrics::Handler::TRAVEL;
+        case Verb::LOOK: return Metrics::Handler::LOOK;
+        case Verb::TAKE: return Metrics::Handler::TAKE;
+        case Verb::USE: return Metrics::Handler::USE;
+        case Verb::ATTACK: return Metrics::Handler::ATTACK;
+        case Verb::INVENTORY: return Metrics::Handler::INVENTORY;
+        case Verb::MEMORY: return Metrics::Handler::MEMORY;
+        case Verb::SAVE: return Metrics::Handler::SAVE;
+        case Verb::LOAD: return Metrics::Handler::LOAD;
+        case Verb::HELP: return Metrics::Handler::HELP;
+        case Verb::QUIT: return Metrics::Handler::QUIT;
+        case Verb::STATUS: return Metrics::Handler::STATUS;
+        default: return Metrics::Handler::UNKNOWN;
+    }
+}
+
+} // namespace
+
+GameEngine::GameEngine(OutputSink& output, std::shared_ptr<const GameData> data, uint64_t seed, uint64_t stream)
+    : out(output), inputState(InputState::NAME), rng(seed, stream), data(std::move(data)), currentRoomId(NO_ROOM), gameRunning(false), gameWon(false), turnsPlayed(0), metrics(nullptr), admin(false), combatEnemy(NO_ENEMY), turnAdvanced(false) {}
+
+GameEngine::GameEngine(const GameEngine& other, OutputSink& output)
+    : out(output), inputState(other.inputState), rng(other.rng), data(other.data),
+      player(other.player ? std::make_unique<Player>(*other.player) : nullptr), world(other.world),
+      currentRoomId(other.currentRoomId), gameRunning(other.gameRunning), gameWon(other.gameWon),
+      turnsPlayed(other.turnsPlayed), questFlags(other.questFlags),
+      savedGame(other.savedGame), metrics(nullptr), admin(false), combatEnemy(other.combatEnemy), turnAdvanced(false) {}
+
+GameEngine::~GameEngine() {
+    if (journal) {
+        journal->finish(turnsPlayed, gameWon);
+    }
+}
+
+void GameEngine::recordTo(std::unique_ptr<JournalWriter> writer) {
+    journal = std::move(writer);
+}
+
+std::unique_ptr<GameEngine> GameEngine::fork(OutputSink& output) const {
+    return std::unique_ptr<GameEngine>(new GameEngine(*this, output));
+}
+
+void GameEngine::step(const std::string& line) {
+    // A failed stream skips every insertion, so nothing is even formatted
+    out.setstate(std::ios::badbit);
+    handleLine(line);
+    out.clear();
+}
+
+void GameEngine::legalCommands(std::vector<std::string>& commands) const {
+    commands.clear();
+    auto addOnce = [&commands](std::string command) {
+        if (std::find(commands.begin(), commands.end(), command) == commands.end()) {
+            commands.push_back(std::move(command));
+        }
+    };
+    
+    switch (inputState) {
+        case InputState::COMMAND: {
+            if (world.getEnemies().hasEnemies(currentRoomId)) {
+                // Enemies block the exits
+                addOnce("attack");
+            } else {
+                for (size_t direction = 0; direction < DIRECTION_COUNT; ++direction) {
+                    if (world.getExit(currentRoomId, static_cast<Direction>(direction)) != NO_ROOM) {
+                        addOnce(directionName(static_cast<Direction>(direction)));
+                    }
+                }
+            }
+            for (const auto& item : currentRoom().getItems()) {
+                addOnce("take " + item->getName());
+            }
+            for (const auto& stack : player->getInventory().getStacks()) {
+                const Item& item = data->items[stack.item];
+                bool useful = item.getType() == Item::Type::POTION ? player->getHealth() < player->getMaxHealth()
+                                                                   : data->triggers.find(TriggerEvent::USE, stack.item, currentRoomId) != nullptr;
+                if (useful) {
+                    addOnce("use " + item.getName());
+                }
+            }
+            break;
+        }
+        case InputState::COMBAT_CHOICE:
+            addOnce("attack");
+            addOnce("flee");
+            for (const auto& stack : player->getInventory().getStacks()) {
+                if (data->items[stack.item].getType() == Item::Type::POTION) {
+                    addOnce("use");
+                }
+            }
+            break;
+        case InputState::COMBAT_ITEM:
+            for (const auto& stack : player->getInventory().getStacks()) {
+                if (data->items[stack.item].getType() == Item::Type::POTION) {
+                    addOnce(data->items[stack.item].getName());
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+uint64_t GameEngine::stateHash() const {
+    uint64_t hash = hashMix(static_cast<uint64_t>(inputState), currentRoomId);
+    hash = hashMix(hash, combatEnemy);
+    hash = hashMix(hash, questFlags.hashState());
+    if (player) {
+        hash = hashMix(hash, player->hashState());
+    }
+    return hashMix(hash, world.hashState());
+}
+
+void GameEngine::startGame(InputSource& input) {
+    beginSession();
     
-    std::string playerName;
-    std::cout << "Enter your name: ";
-    std::getline(std::cin, playerName);
+    std::string line;
+    while (!isFinished()) {
+        // Everything rendered since the last prompt goes out in one write
+        out.flushTurn();
+        
+        if (!input.readLine(line)) {
+            endInput();
+            break;
+        }
+        handleLine(line);
+        if (metrics) {
+            metrics->dumpIfDue();
+        }
+    }
+    out.flushTurn();
+}
+
+void GameEngine::replay(const Journal& recorded) {
+    beginSession();
     
+    // No waiting on input: the whole session is already in memory
+    for (const auto& entry : recorded.entries) {
+        if (isFinished()) break;
+        out.flushTurn();
+        
+        // Save data the line read from disk comes from the journal instead
+        if (entry.snapshot) {
+            savedGame = *entry.snapshot;
+        }
+        handleLine(entry.line);
+    }
+    endInput();
+    out.flushTurn();
+}
+
+void GameEngine::beginSession() {
+    if (metrics) {
+        metrics->increment(Metrics::Counter::SESSIONS);
+    }
+    
+    out << "========================================\n";
+    out << "   Echoes of the Forgotten Realm\n";
+    out << "========================================\n";
+    out << "\nYou awaken in a ruined world with no memory...\n";
+    out << "Explore, survive, and uncover your forgotten past.\n\n";
+    
+    inputState = InputState::NAME;
+    showPrompt();
+}
+
+void GameEngine::handleLine(const std::string& line) {
+    if (journal && inputState != InputState::FINISHED) {
+        journal->record(line);
+    }
+    
+    switch (inputState) {
+        case InputState::NAME:
+            handleName(line);
+            break;
+        case InputState::COMMAND:
+            handleCommandLine(line);
+            break;
+        case InputState::COMBAT_CHOICE:
+            handleCombatChoice(line);
+            break;
+        case InputState::COMBAT_ITEM:
+            handleCombatItem(line);
+            break;
+        case InputState::QUIT_CONFIRM:
+            handleQuitConfirm(line);
+            break;
+        case InputState::FINISHED:
+            break;
+    }
+}
+
+void GameEngine::endInput() {
+    if (inputState == InputState::FINISHED) return;
+    
+    // Input exhausted (end of script, closed stdin or dropped connection) ends the session
+    if (combatEnemy != NO_ENEMY) {
+        combatEnemy = NO_ENEMY;
+        out << "\n*** COMBAT ENDS ***\n";
+    }
+    gameRunning = false;
+    inputState = InputState::FINISHED;
+}
+
+void GameEngine::handleName(const std::string& line) {
+    Metrics::Timer timer(metrics, Metrics::Handler::START);
+    std::string playerName = line;
     if (playerName.empty()) {
         playerName = "Unknown";
     }
     
-    player = std::make_unique<Player>(playerName);
+    player = std::make_unique<Player>(playerName, *data);
     
     // Initialize the game world
-    populateWorld();
+    populateWorld(world);
     
-    // Start in the wrecked village
-    currentRoom = rooms["village"];
-    currentRoom->setVisited(true);
+    // Start in the first room of the content
+    currentRoomId = 0;
+    world.visit(currentRoomId);
+    scheduleHazard();
     
     gameRunning = true;
     
-    std::cout << "\nWelcome, " << player->getName() << "!" << std::endl;
-    std::cout << "Type 'help' for available commands.\n" << std::endl;
+    out << "\nWelcome, " << player->getName() << "!\n";
+    out << "Type 'help' for available commands.\n\n";
     
-    currentRoom->displayRoom();
+    currentRoom().displayRoom(out, world);
+    fireTrigger(TriggerEvent::ENTER, NO_ITEM);
     
-    gameLoop();
+    inputState = InputState::COMMAND;
+    out << "\n> ";
 }
 
-void GameEngine::gameLoop() {
-    std::string input;
+void GameEngine::handleCommandLine(const std::string& line) {
+    lineBuffer.assign(line);
+    parseCommandLine(lineBuffer, command);
+    if (command.empty()) {
+        out << "\n> ";
+        return;
+    }
     
-    while (gameRunning && player->isAlive()) {
-        std::cout << "\n> ";
-        std::getline(std::cin, input);
-        
-        if (input.empty()) continue;
-        
-        auto command = parseCommand(input);
-        if (!command.empty()) {
-            processCommand(command);
-            turnsPlayed++;
-            
-            // Check for environmental hazards
-            checkRoomHazards();
-            
-            // Check win condition
-            checkWinCondition();
+    // Admin commands are outside the game: no turn passes
+    if (command.verb == Verb::METRICS) {
+        handleMetrics();
+        out << "\n> ";
+        return;
+    }
+    
+    turnAdvanced = false;
+    {
+        Metrics::Timer timer(metrics, handlerOf(command.verb));
+        processCommand(command);
+    }
+    
+    // Combat and quit confirmation finish the turn once they get their
+    // answer, and travel advances the turns of its steps itself
+    if (inputState == InputState::COMMAND) {
+        if (turnAdvanced) {
+            endTurn();
+        } else {
+            finishTurn();
+        }
+    }
+}
+
+void GameEngine::finishTurn() {
+    advanceTurn();
+    endTurn();
+}
+
+bool GameEngine::advanceTurn() {
+    Metrics::Timer timer(metrics, Metrics::Handler::TURN);
+    turnsPlayed++;
+    if (metrics) {
+        metrics->increment(Metrics::Counter::TURNS);
+    }
+    
+    // Whatever was filed for this turn: wandering enemies, and hazards and
+    // encounters of the room the player came to, if still there
+    uint32_t turn = static_cast<uint32_t>(turnsPlayed);
+    dueEvents.clear();
+    world.advanceTo(turn, dueEvents);
+    for (const TimedEvent& event : dueEvents) {
+        switch (static_cast<World::Event>(event.kind)) {
+            case World::Event::ENEMY_MOVE:
+                world.moveEnemy(event.payload, rng, currentRoomId, turn);
+                break;
+            case World::Event::HAZARD:
+                if (event.payload == currentRoomId) {
+                    checkRoomHazards();
+                    scheduleHazard();
+                }
+                break;
+            case World::Event::ENCOUNTER:
+                if (event.payload == currentRoomId) {
+                    rollEncounter();
+                }
+                break;
         }
     }
     
+    // Enemies elsewhere in the world heal, and new wanderers set off
+    world.tick(rng, currentRoomId, turn);
+    
+    return gameRunning && player->isAlive();
+}
+
+void GameEngine::endTurn() {
+    if (gameRunning && player->isAlive()) {
+        inputState = InputState::COMMAND;
+        out << "\n> ";
+        return;
+    }
+    
     if (!player->isAlive()) {
+        if (metrics) metrics->increment(Metrics::Counter::DEATHS);
         endGame(false);
     } else if (gameWon) {
+        if (metrics) metrics->increment(Metrics::Counter::WINS);
         endGame(true);
     }
+    gameRunning = false;
+    inputState = InputState::FINISHED;
 }
 
-std::vector<std::string> GameEngine::parseCommand(const std::string& input) {
-    std::vector<std::string> tokens;
-    std::istringstream iss(input);
-    std::string token;
-    
-    while (iss >> token) {
-        tokens.push_back(toLowerCase(token));
+void GameEngine::processCommand(const Command& command) {
+    switch (command.verb) {
+        case Verb::LOOK:
+            handleLook();
+            break;
+        case Verb::MOVE:
+            if (command.count > 1) {
+                handleMove(parseDirection(command.word(1)));
+            } else {
+                out << "Move where? (north, south, east, west)\n";
+            }
+            break;
+        case Verb::NORTH:
+            handleMove(Direction::NORTH);
+            break;
+        case Verb::SOUTH:
+            handleMove(Direction::SOUTH);
+            break;
+        case Verb::EAST:
+            handleMove(Direction::EAST);
+            break;
+        case Verb::WEST:
+            handleMove(Direction::WEST);
+            break;
+        case Verb::TRAVEL:
+            if (command.count > 1) {
+                handleTravel(command.rest);
+            } else {
+                out << "Travel where?\n";
+            }
+            break;
+        case Verb::TAKE:
+            // Multi-word item names are the rest of the line
+            if (command.count > 1) {
+                handleTake(command.rest);
+            } else {
+                out << "Take what?\n";
+            }
+            break;
+        case Verb::USE:
+            if (command.count > 1) {
+                handleUse(command.rest);
+            } else {
+                out << "Use what?\n";
+            }
+            break;
+        case Verb::ATTACK:
+            handleAttack(command.word(1));
+            break;
+        case Verb::INVENTORY:
+            handleInventory();
+            break;
+        case Verb::MEMORY:
+            handleMemory();
+            break;
+        case Verb::SAVE:
+            handleSave();
+            break;
+        case Verb::LOAD:
+            handleLoad();
+            break;
+        case Verb::HELP:
+            handleHelp();
+            break;
+        case Verb::QUIT:
+            handleQuit();
+            break;
+        case Verb::STATUS:
+            displayGameInfo();
+            break;
+        case Verb::NONE:
+        default:
+            out << "I don't understand that command. Type 'help' for available commands.\n";
+            break;
     }
-    
-    return tokens;
 }
 
-void GameEngine::processCommand(const std::vector<std::string>& command) {
-    if (command.empty()) return;
-    
-    const std::string& action = command[0];
+bool GameEngine::blockedByEnemies() {
+    if (!world.getEnemies().hasEnemies(currentRoomId)) return false;
+    out << "You can't leave while enemies are present! You must fight or find another way.\n";
+    return true;
+}
+
+void GameEngine::handleMove(Direction direction) {
+    if (blockedByEnemies()) return;
     
-    if (action == "look" || action == "l") {
-        handleLook();
-    }
-    else if (action == "move" || action == "go" || action == "m") {
-        if (command.size() > 1) {
-            handleMove(command[1]);
-        } else {
-            std::cout << "Move where? (north, south, east, west)" << std::endl;
-        }
-    }
-    else if (action == "north" || action == "n") {
-        handleMove("north");
-    }
-    else if (action == "south" || action == "s") {
-        handleMove("south");
-    }
-    else if (action == "east" || action == "e") {
-        handleMove("east");
-    }
-    else if (action == "west" || action == "w") {
-        handleMove("west");
-    }
-    else if (action == "take" || action == "get" || action == "pick") {
-        if (command.size() > 1) {
-            // Handle multi-word item names
-            std::string fullItemName;
-            for (size_t i = 1; i < command.size(); ++i) {
-                if (i > 1) fullItemName += " ";
-                fullItemName += command[i];
-            }
-            handleTake(fullItemName);
-        } else {
-            std::cout << "Take what?" << std::endl;
-        }
-    }
-    else if (action == "use") {
-        if (command.size() > 1) {
-            handleUse(command[1]);
-        } else {
-            std::cout << "Use what?" << std::endl;
-        }
-    }
-    else if (action == "attack" || action == "fight") {
-        if (command.size() > 1) {
-            handleAttack(command[1]);
-        } else {
-            handleAttack("");
-        }
-    }
-    else if (action == "inventory" || action == "i" || action == "inv") {
-        handleInventory();
-    }
-    else if (action == "memory" || action == "journal") {
-        handleMemory();
-    }
-    else if (action == "save") {
-        handleSave();
-    }
-    else if (action == "load") {
-        handleLoad();
-    }
-    else if (action == "help" || action == "h") {
-        handleHelp();
-    }
-    else if (action == "quit" || action == "exit" || action == "q") {
-        handleQuit();
-    }
-    else if (action == "status" || action == "stats") {
-        displayGameInfo();
+    RoomId nextRoomId = world.getExit(currentRoomId, direction);
+    if (nextRoomId == NO_ROOM) {
+        out << "You can't go that way.\n";
+        return;
     }
-    else {
-        std::cout << "I don't understand that command. Type 'help' for available commands." << std::endl;
+    
+    out << "You move " << directionName(direction) << "...\n";
+    currentRoomId = nextRoomId;
+    world.visit(currentRoomId);
+    const Room& room = currentRoom();
+    
+    // The room's hazard and random encounter (rolled on every arrival)
+    // come as the turn passes
+    scheduleHazard();
+    if (room.getEncounterChance() > 0 && !data->encounters.empty()) {
+        world.schedule(static_cast<uint32_t>(turnsPlayed) + 1, World::Event::ENCOUNTER, currentRoomId);
     }
+    
+    room.displayRoom(out, world);
+    fireTrigger(TriggerEvent::ENTER, NO_ITEM);
 }
 
-void GameEngine::handleMove(const std::string& direction) {
-    if (currentRoom->hasAliveEnemies()) {
-        std::cout << "You can't leave while enemies are present! You must fight or find another way." << std::endl;
+void GameEngine::handleTravel(std::string_view destination) {
+    RoomId target = world.findRoomByName(destination);
+    if (target == NO_ROOM) {
+        target = world.findRoom(destination);
+    }
+    // Only places the player has been to are known by name
+    if (target == NO_ROOM || !world.isVisited(target)) {
+        out << "You don't know the way to " << destination << ".\n";
         return;
     }
-    
-    std::string nextRoomId = currentRoom->getExit(direction);
-    if (nextRoomId.empty()) {
-        std::cout << "You can't go that way." << std::endl;
+    if (target == currentRoomId) {
+        out << "You are already there.\n";
         return;
     }
-    
-    auto nextRoom = rooms.find(nextRoomId);
-    if (nextRoom != rooms.end()) {
-        std::cout << "You move " << direction << "..." << std::endl;
-        currentRoom = nextRoom->second;
-        
-        if (!currentRoom->isVisited()) {
-            currentRoom->setVisited(true);
+    if (world.routeStep(currentRoomId, target) == Direction::NONE) {
+        out << "There is no way to " << world.roomName(target) << " from here.\n";
+        return;
+    }
+    // The trip is only announced once its first step can be taken
+    if (blockedByEnemies()) return;
+    
+    out << "You set off for " << world.roomName(target) << ".\n";
+    for (;;) {
+        // Every step is an ordinary move taking its own turn: enemies block
+        // it and the encounters that turn brings can stop it
+        RoomId from = currentRoomId;
+        handleMove(world.routeStep(currentRoomId, target));
+        if (currentRoomId == from) return;
+        turnAdvanced = true;
+        if (!advanceTurn()) {
+            endTurn();
+            return;
         }
-        
-        // Add random encounters in some rooms (even if visited before)
-        if (nextRoomId == "forest" || nextRoomId == "cave") {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> dis(1, 100);
-            
-            if (dis(gen) <= 60) { // 60% chance of encounter
-                auto enemy = std::make_shared<Enemy>(Enemy::createRandomEnemy());
-                currentRoom->addEnemy(enemy);
-                std::cout << "A " << enemy->getName() << " appears!" << std::endl;
-            }
+        if (currentRoomId == target) return;
+        if (world.getEnemies().hasEnemies(currentRoomId)) {
+            out << "Your journey is interrupted!\n";
+            return;
         }
-        
-        currentRoom->displayRoom();
-    } else {
-        std::cout << "Error: Room not found." << std::endl;
     }
 }
 
 void GameEngine::handleLook() {
-    currentRoom->lookAround();
+    currentRoom().lookAround(out, world);
 }
 
-void GameEngine::handleTake(const std::string& itemName) {
-    auto item = currentRoom->takeItem(itemName);
+void GameEngine::handleTake(std::string_view itemName) {
+    // Only rooms that actually lose an item need their own copy
+    auto item = currentRoom().hasItem(itemName) ? editCurrentRoom().takeItem(itemName) : nullptr;
     if (item) {
-        player->addItem(item);
-        
-        // Check for memory triggers
-        if (item->getName() == "rusty sword") {
-            player->addMemory("You remember wielding this blade in battle against the Shadow Forces...");
-        } else if (item->getName() == "ancient key") {
-            player->addMemory("This key once opened the doors to your forgotten castle...");
-        } else if (item->getName() == "crystal shard") {
-            player->addMemory("The crystal resonates with power - a fragment of the Realm's heart...");
-        }
+        player->addItem(*item, out);
+        fireTrigger(TriggerEvent::TAKE, item->getId());
         
         // Auto-equip weapons
         if (item->getType() == Item::Type::WEAPON) {
-            player->equipWeapon(item);
+            player->equipWeapon(*item, out);
         }
     } else {
-        std::cout << "There's no " << itemName << " here." << std::endl;
+        out << "There's no " << itemName << " here.\n";
     }
 }
 
-void GameEngine::handleUse(const std::string& itemName) {
-    auto item = player->getItem(itemName);
+void GameEngine::handleUse(std::string_view itemName) {
+    const Item* item = player->getItem(itemName);
     if (!item) {
-        std::cout << "You don't have a " << itemName << "." << std::endl;
+        out << "You don't have a " << itemName << ".\n";
         return;
     }
     
     if (item->getType() == Item::Type::POTION) {
-        player->heal(item->getEffect());
+        player->heal(item->getEffect(), out);
         player->removeItem(itemName);
-        std::cout << "You used the " << itemName << "." << std::endl;
+        out << "You used the " << itemName << ".\n";
     }
-    else if (item->getType() == Item::Type::KEY) {
-        if (currentRoom->getId() == "temple" && itemName == "ancient key") {
-            currentRoom->setSpecialEvent("You unlock the hidden chamber! A passage opens to the north.");
-            currentRoom->addExit("north", "chamber");
-            std::cout << "The ancient key fits perfectly! A hidden passage opens." << std::endl;
+    else if (!fireTrigger(TriggerEvent::USE, item->getId())) {
+        // Nothing happens; keys at least belong somewhere
+        if (item->getType() == Item::Type::KEY) {
+            out << "The " << itemName << " doesn't work here.\n";
         } else {
-            std::cout << "The " << itemName << " doesn't work here." << std::endl;
+            out << "You can't use that item.\n";
         }
     }
-    else {
-        std::cout << "You can't use that item." << std::endl;
-    }
 }
 
-void GameEngine::handleAttack(const std::string& target) {
-    auto enemy = currentRoom->getAliveEnemy();
-    if (!enemy) {
-        std::cout << "There's nothing to attack here." << std::endl;
+void GameEngine::handleAttack(std::string_view /*target*/) {
+    EnemyId enemy = world.getEnemies().firstInRoom(currentRoomId);
+    if (enemy == NO_ENEMY) {
+        out << "There's nothing to attack here.\n";
         return;
     }
     
     handleCombat(enemy);
 }
 
-void GameEngine::handleCombat(std::shared_ptr<Enemy> enemy) {
-    std::cout << "\n*** COMBAT BEGINS ***" << std::endl;
-    enemy->showStatus();
-    std::cout << "**********************" << std::endl;
+void GameEngine::handleCombat(EnemyId enemy) {
+    if (metrics) {
+        metrics->increment(Metrics::Counter::COMBATS);
+    }
+    out << "\n*** COMBAT BEGINS ***\n";
+    world.getEnemies().showStatus(enemy, out);
+    out << "**********************\n";
     
-    while (enemy->alive() && player->isAlive()) {
-        std::cout << "\nWhat do you want to do?" << std::endl;
-        std::cout << "1. Attack (or type 'attack')" << std::endl;
-        std::cout << "2. Use item (or type 'use')" << std::endl;
-        std::cout << "3. Try to flee (or type 'flee')" << std::endl;
-        std::cout << "> ";
-        
-        std::string choice;
-        std::getline(std::cin, choice);
-        choice = toLowerCase(choice);
-        
-        if (choice == "1" || choice == "attack" || choice == "a" || choice.find("attack") != std::string::npos) {
-            if (playerAttack(enemy)) {
-                if (!enemy->alive()) {
-                    std::cout << "\nYou defeated the " << enemy->getName() << "!" << std::endl;
-                    player->addGold(enemy->getGoldReward());
-                    std::cout << "You gained " << enemy->getGoldReward() << " gold." << std::endl;
-                    
-                    if (enemy->getType() == Enemy::Type::BOSS) {
-                        finalBossDefeated = true;
-                        player->addMemory("You have defeated the Shadow Lord and restored balance to the realm!");
-                    }
-                    
-                    currentRoom->removeDeadEnemies();
-                    break;
-                }
+    combatEnemy = enemy;
+    promptCombat();
+}
+
+void GameEngine::continueCombat() {
+    if (!gameRunning || !world.getEnemies().isAlive(combatEnemy) || !player->isAlive()) {
+        endCombat();
+    } else {
+        promptCombat();
+    }
+}
+
+void GameEngine::promptCombat() {
+    out << "\nWhat do you want to do?\n";
+    out << "1. Attack (or type 'attack')\n";
+    out << "2. Use item (or type 'use')\n";
+    out << "3. Try to flee (or type 'flee')\n";
+    out << "> ";
+    inputState = InputState::COMBAT_CHOICE;
+}
+
+void GameEngine::handleCombatChoice(const std::string& line) {
+    Metrics::Timer timer(metrics, Metrics::Handler::COMBAT);
+    EnemyId enemy = combatEnemy;
+    lineBuffer.assign(line);
+    std::string_view choice = normalizeLine(lineBuffer);
+    
+    if (choice == "1" || choice == "attack" || choice == "a" || choice.find("attack") != std::string_view::npos) {
+        if (playerAttack(enemy)) {
+            // Looked up after the attack, which may have given this session its own copy
+            const EnemyStore& enemies = world.getEnemies();
+            if (!enemies.isAlive(enemy)) {
+                out << "\nYou defeated the " << enemies.getName(enemy) << "!\n";
+                player->addGold(enemies.getGoldReward(enemy));
+                out << "You gained " << enemies.getGoldReward(enemy) << " gold.\n";
                 
-                if (enemyAttack(enemy)) {
-                    if (!player->isAlive()) {
-                        std::cout << "\nYou have been defeated..." << std::endl;
-                        break;
-                    }
+                if (enemies.getType(enemy) == Enemy::Type::BOSS) {
+                    setQuestFlag(QuestFlag::BOSS_DEFEATED);
+                    recoverMemory(data->victoryMemory);
                 }
+                
+                endCombat();
+                return;
             }
-        }
-        else if (choice == "2" || choice == "use" || choice == "use item") {
-            std::cout << "Use which item? ";
-            std::string itemName;
-            std::getline(std::cin, itemName);
-            handleUse(toLowerCase(itemName));
-        }
-        else if (choice == "3" || choice == "flee" || choice == "try to flee" || choice.find("flee") != std::string::npos) {
-            std::cout << "You attempt to flee..." << std::endl;
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> dis(1, 100);
             
-            if (dis(gen) <= 70) { // 70% success rate
-                std::cout << "You successfully escape!" << std::endl;
-                break;
-            } else {
-                std::cout << "You couldn't escape!" << std::endl;
-                enemyAttack(enemy);
+            if (enemyAttack(enemy)) {
+                if (!player->isAlive()) {
+                    out << "\nYou have been defeated...\n";
+                    endCombat();
+                    return;
+                }
             }
         }
-        else {
-            std::cout << "Invalid choice." << std::endl;
+    }
+    else if (choice == "2" || choice == "use" || choice == "use item") {
+        inputState = InputState::COMBAT_ITEM;
+        showPrompt();
+        return;
+    }
+    else if (choice == "3" || choice == "flee" || choice == "try to flee" || choice.find("flee") != std::string_view::npos) {
+        out << "You attempt to flee...\n";
+        if (rng.chance(70)) { // 70% success rate
+            out << "You successfully escape!\n";
+            endCombat();
+            return;
+        } else {
+            out << "You couldn't escape!\n";
+            enemyAttack(enemy);
         }
     }
+    else {
+        out << "Invalid choice.\n";
+    }
     
-    std::cout << "\n*** COMBAT ENDS ***" << std::endl;
+    continueCombat();
 }
 
-bool GameEngine::playerAttack(std::shared_ptr<Enemy> enemy) {
+void GameEngine::handleCombatItem(const std::string& line) {
+    Metrics::Timer timer(metrics, Metrics::Handler::COMBAT);
+    lineBuffer.assign(line);
+    handleUse(normalizeLine(lineBuffer));
+    continueCombat();
+}
+
+void GameEngine::endCombat() {
+    out << "\n*** COMBAT ENDS ***\n";
+    combatEnemy = NO_ENEMY;
+    inputState = InputState::COMMAND;
+    finishTurn();
+}
+
+bool GameEngine::playerAttack(EnemyId enemy) {
+    EnemyStore& enemies = world.editEnemies();
     int damage = player->getAttack();
-    std::cout << "You attack the " << enemy->getName() << " for " << damage << " damage!" << std::endl;
-    enemy->takeDamage(damage);
+    out << "You attack the " << enemies.getName(enemy) << " for " << damage << " damage!\n";
+    enemies.takeDamage(enemy, damage, out);
     return true;
 }
 
-bool GameEngine::enemyAttack(std::shared_ptr<Enemy> enemy) {
-    int damage = enemy->performAttack();
-    player->takeDamage(damage);
+bool GameEngine::enemyAttack(EnemyId enemy) {
+    int damage = world.getEnemies().performAttack(enemy, rng, out);
+    player->takeDamage(damage, out);
     return true;
 }
 
 void GameEngine::handleInventory() {
-    player->showInventory();
+    player->showInventory(out);
 }
 
 void GameEngine::handleMemory() {
-    player->showMemoryJournal();
+    player->showMemoryJournal(out);
 }
 
 void GameEngine::handleSave() {
-    std::cout << "Game saved! (Save system would store current state)" << std::endl;
-    // In a full implementation, this would save to a file
+    saveState(savedGame);
+    
+    if (!saveFile.empty()) {
+        std::ofstream file(saveFile, std::ios::binary | std::ios::trunc);
+        if (!file.write(savedGame.data(), static_cast<std::streamsize>(savedGame.size()))) {
+            out << "Could not write " << saveFile << ".\n";
+            return;
+        }
+    }
+    out << "Game saved!\n";
 }
 
 void GameEngine::handleLoad() {
-    std::cout << "Game loaded! (Load system would restore saved state)" << std::endl;
-    // In a full implementation, this would load from a file
+    if (!saveFile.empty()) {
+        std::ifstream file(saveFile, std::ios::binary);
+        std::string fromFile(std::istreambuf_iterator<char>(file), {});
+        
+        // A save written outside this session is input a replay cannot recreate
+        if (journal && fromFile != savedGame) {
+            journal->recordSnapshot(fromFile);
+        }
+        savedGame = std::move(fromFile);
+    }
+    if (savedGame.empty()) {
+        out << "There is no saved game to load.\n";
+        return;
+    }
+    
+    try {
+        loadState(savedGame);
+    } catch (const std::runtime_error& e) {
+        out << "Could not load the saved game: " << e.what() << '\n';
+        return;
+    }
+    
+    out << "Game loaded!\n";
+    currentRoom().displayRoom(out, world);
+    
+    // A save made mid-fight picks the fight up again; the turn ends once it does
+    if (inputState != InputState::COMMAND) {
+        showPrompt();
+    }
+}
+
+void GameEngine::saveState(std::string& buffer) const {
+    if (!player) {
+        throw std::logic_error("No game in progress to save");
+    }
+    
+    buffer.clear();
+    SnapshotWriter writer(buffer);
+    writer.write(SAVE_MAGIC);
+    writer.write(SAVE_VERSION);
+    writer.write(data->fingerprint);
+    
+    writer.write(rng.getState());
+    writer.write(rng.getIncrement());
+    writer.write(currentRoomId);
+    writer.write<int32_t>(turnsPlayed);
+    writer.write(static_cast<uint8_t>(inputState));
+    writer.write(combatEnemy);
+    questFlags.saveState(writer);
+    
+    player->saveState(writer);
+    world.saveState(writer);
+}
+
+void GameEngine::loadState(std::string_view snapshot) {
+    SnapshotReader reader(snapshot);
+    if (reader.read<uint32_t>() != SAVE_MAGIC) {
+        SnapshotReader::fail("not a save file");
+    }
+    uint32_t version = reader.read<uint32_t>();
+    if (version != SAVE_VERSION) {
+        SnapshotReader::fail("unsupported save version " + std::to_string(version));
+    }
+    if (reader.read<uint64_t>() != data->fingerprint) {
+        SnapshotReader::fail("the save was made with different game data");
+    }
+    
+    uint64_t rngState = reader.read<uint64_t>();
+    uint64_t rngIncrement = reader.read<uint64_t>();
+    RoomId roomId = reader.read<RoomId>();
+    int32_t turns = reader.read<int32_t>();
+    uint8_t state = reader.read<uint8_t>();
+    EnemyId enemy = reader.read<EnemyId>();
+    FlagSet loadedFlags;
+    loadedFlags.loadState(reader, QUEST_FLAG_COUNT);
+    
+    // Restore into a fresh player and world, so a bad save changes nothing
+    auto loadedPlayer = std::make_unique<Player>("", *data);
+    loadedPlayer->loadState(reader);
+    
+    World loadedWorld;
+    populateWorld(loadedWorld);
+    loadedWorld.loadState(reader, *data);
+    
+    if (roomId >= loadedWorld.size()) {
+        SnapshotReader::fail("the save puts the player in an unknown room");
+    }
+    
+    // Sessions are saved wherever they wait for input, fights included
+    InputState loadedState = static_cast<InputState>(state);
+    bool fighting = loadedState == InputState::COMBAT_CHOICE || loadedState == InputState::COMBAT_ITEM;
+    if (!fighting && loadedState != InputState::COMMAND && loadedState != InputState::QUIT_CONFIRM) {
+        SnapshotReader::fail("the save waits at an unknown prompt");
+    }
+    const EnemyStore& enemies = loadedWorld.getEnemies();
+    bool validEnemy = fighting ? enemy < enemies.size() && enemies.isAlive(enemy) && enemies.getRoom(enemy) == roomId
+                               : enemy == NO_ENEMY;
+    if (!validEnemy) {
+        SnapshotReader::fail("the save is fighting an enemy that is not there");
+    }
+    if (!reader.atEnd()) {
+        SnapshotReader::fail("unexpected data after the end of the save");
+    }
+    loadedWorld.visit(roomId);
+    
+    player = std::move(loadedPlayer);
+    world = std::move(loadedWorld);
+    rng.restore(rngState, rngIncrement);
+    currentRoomId = roomId;
+    turnsPlayed = turns;
+    questFlags = std::move(loadedFlags);
+    combatEnemy = enemy;
+    gameRunning = true;
+    gameWon = false;
+    inputState = loadedState;
+}
+
+void GameEngine::showPrompt() {
+    switch (inputState) {
+        case InputState::NAME:
+            out << "Enter your name: ";
+            break;
+        case InputState::COMMAND:
+            out << "\n> ";
+            break;
+        case InputState::COMBAT_CHOICE:
+            promptCombat();
+            break;
+        case InputState::COMBAT_ITEM:
+            out << "Use which item? ";
+            break;
+        case InputState::QUIT_CONFIRM:
+            out << "Are you sure you want to quit? (y/n): ";
+            break;
+        case InputState::FINISHED:
+            break;
+    }
 }
 
 void GameEngine::handleHelp() {
-    std::cout << "\n=== AVAILABLE COMMANDS ===" << std::endl;
-    std::cout << "Movement:" << std::endl;
-    std::cout << "  move [direction] / go [direction] / [direction]" << std::endl;
-    std::cout << "  north/n, south/s, east/e, west/w" << std::endl;
-    std::cout << "\nInteraction:" << std::endl;
-    std::cout << "  look/l - Examine your surroundings" << std::endl;
-    std::cout << "  take [item] / get [item] - Pick up an item" << std::endl;
-    std::cout << "  use [item] - Use an item from inventory" << std::endl;
-    std::cout << "  attack [enemy] / fight - Start combat" << std::endl;
-    std::cout << "\nInfo:" << std::endl;
-    std::cout << "  inventory/i - Show your items" << std::endl;
-    std::cout << "  memory/journal - View recovered memories" << std::endl;
-    std::cout << "  status - Show your character status" << std::endl;
-    std::cout << "\nGame:" << std::endl;
-    std::cout << "  save - Save your progress" << std::endl;
-    std::cout << "  load - Load saved game" << std::endl;
-    std::cout << "  help/h - Show this help" << std::endl;
-    std::cout << "  quit/exit/q - Exit the game" << std::endl;
-    std::cout << "=========================" << std::endl;
+    out << "\n=== AVAILABLE COMMANDS ===\n";
+    out << "Movement:\n";
+    out << "  move [direction] / go [direction] / [direction]\n";
+    out << "  north/n, south/s, east/e, west/w\n";
+    out << "  travel [room] - Walk to a room you have visited by the shortest route\n";
+    out << "\nInteraction:\n";
+    out << "  look/l - Examine your surroundings\n";
+    out << "  take [item] / get [item] - Pick up an item\n";
+    out << "  use [item] - Use an item from inventory\n";
+    out << "  attack [enemy] / fight - Start combat\n";
+    out << "\nInfo:\n";
+    out << "  inventory/i - Show your items\n";
+    out << "  memory/journal - View recovered memories\n";
+    out << "  status - Show your character status\n";
+    out << "\nGame:\n";
+    out << "  save - Save your progress\n";
+    out << "  load - Load saved game\n";
+    out << "  help/h - Show this help\n";
+    out << "  quit/exit/q - Exit the game\n";
+    out << "=========================\n";
 }
 
 void GameEngine::handleQuit() {
-    std::cout << "Are you sure you want to quit? (y/n): ";
-    std::string response;
-    std::getline(std::cin, response);
-    
-    if (toLowerCase(response) == "y" || toLowerCase(response) == "yes") {
-        std::cout << "Thanks for playing Echoes of the Forgotten Realm!" << std::endl;
+    inputState = InputState::QUIT_CONFIRM;
+    showPrompt();
+}
+
+void GameEngine::handleQuitConfirm(const std::string& line) {
+    Metrics::Timer timer(metrics, Metrics::Handler::QUIT);
+    lineBuffer.assign(line);
+    std::string_view response = normalizeLine(lineBuffer);
+    if (response == "y" || response == "yes") {
+        out << "Thanks for playing Echoes of the Forgotten Realm!\n";
         gameRunning = false;
     }
+    
+    inputState = InputState::COMMAND;
+    finishTurn();
+}
+
+void GameEngine::handleMetrics() {
+    if (!admin || !metrics) {
+        out << "I don't understand that command. Type 'help' for available commands.\n";
+        return;
+    }
+    metrics->report(out);
+}
+
+void GameEngine::scheduleHazard() {
+    if (currentRoom().getHazard() != Room::HazardType::NONE) {
+        world.schedule(static_cast<uint32_t>(turnsPlayed) + 1, World::Event::HAZARD, currentRoomId);
+    }
+}
+
+void GameEngine::rollEncounter() {
+    // Not when the room is crowded already
+    if (world.getEnemies().countInRoom(currentRoomId, ENCOUNTER_CAP) >= ENCOUNTER_CAP) return;
+    if (!rng.chance(currentRoom().getEncounterChance())) return;
+    
+    // Encounters left behind keep roaming the world; the store reuses the
+    // ids of dead ones
+    uint32_t pick = data->encounters[rng.range(0, static_cast<int>(data->encounters.size()) - 1)];
+    EnemyId enemy = world.editEnemies().spawn(data->enemies[pick], currentRoomId, true);
+    out << "A " << world.getEnemies().getName(enemy) << " appears!\n";
+    if (metrics) {
+        metrics->increment(Metrics::Counter::ENCOUNTERS);
+    }
 }
 
 void GameEngine::checkRoomHazards() {
-    auto hazard = currentRoom->getHazard();
+    auto hazard = currentRoom().getHazard();
     if (hazard != Room::HazardType::NONE) {
         switch (hazard) {
             case Room::HazardType::POISON:
             case Room::HazardType::CURSED:
-                player->takeDamage(2);
+                player->takeDamage(2, out);
                 break;
             case Room::HazardType::COLD:
             case Room::HazardType::HOT:
-                player->takeDamage(1);
+                player->takeDamage(1, out);
                 break;
             default:
                 break;
@@ -414,115 +913,78 @@ void GameEngine::checkRoomHazards() {
     }
 }
 
+void GameEngine::setQuestFlag(QuestFlag flag) {
+    if (questFlags.set(static_cast<FlagId>(flag))) {
+        checkWinCondition();
+    }
+}
+
+bool GameEngine::fireTrigger(TriggerEvent event, ItemId item) {
+    const TriggerRule* rule = data->triggers.find(event, item, currentRoomId);
+    if (!rule) return false;
+
+    if (!rule->message.empty()) {
+        out << rule->message << '\n';
+    }
+    if (!rule->specialEvent.empty()) {
+        editCurrentRoom().setSpecialEvent(std::string(rule->specialEvent));
+    }
+    for (size_t direction = 0; direction < DIRECTION_COUNT; ++direction) {
+        if (rule->opens[direction] != NO_ROOM) {
+            world.setExit(currentRoomId, static_cast<Direction>(direction), rule->opens[direction]);
+        }
+    }
+    if (rule->memory != NO_MEMORY) {
+        recoverMemory(rule->memory);
+    }
+    return true;
+}
+
+void GameEngine::recoverMemory(MemoryId memory) {
+    if (player->addMemory(memory, out)) {
+        checkWinCondition();
+    }
+}
+
 void GameEngine::checkWinCondition() {
-    if (finalBossDefeated && player->hasMemory("You have defeated the Shadow Lord and restored balance to the realm!")) {
+    if (questFlags.test(static_cast<FlagId>(QuestFlag::BOSS_DEFEATED)) && player->hasMemory(data->victoryMemory)) {
         gameWon = true;
         gameRunning = false;
     }
 }
 
 void GameEngine::displayGameInfo() {
-    std::cout << "\n=== CHARACTER STATUS ===" << std::endl;
-    std::cout << "Name: " << player->getName() << std::endl;
-    std::cout << "Health: " << player->getHealth() << "/" << player->getMaxHealth() << std::endl;
-    std::cout << "Attack: " << player->getAttack() << std::endl;
-    std::cout << "Defense: " << player->getDefense() << std::endl;
-    std::cout << "Gold: " << player->getGold() << std::endl;
-    std::cout << "Current Location: " << currentRoom->getName() << std::endl;
-    std::cout << "Turns Played: " << turnsPlayed << std::endl;
-    std::cout << "========================" << std::endl;
-}
-
-std::string GameEngine::toLowerCase(const std::string& str) {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
+    out << "\n=== CHARACTER STATUS ===\n";
+    out << "Name: " << player->getName() << '\n';
+    out << "Health: " << player->getHealth() << "/" << player->getMaxHealth() << '\n';
+    out << "Attack: " << player->getAttack() << '\n';
+    out << "Defense: " << player->getDefense() << '\n';
+    out << "Gold: " << player->getGold() << '\n';
+    out << "Current Location: " << currentRoom().getName() << '\n';
+    out << "Turns Played: " << turnsPlayed << '\n';
+    out << "========================\n";
 }
 
 void GameEngine::endGame(bool won) {
-    std::cout << "\n========================================" << std::endl;
+    out << "\n========================================\n";
     if (won) {
-        std::cout << "         CONGRATULATIONS!" << std::endl;
-        std::cout << "   You have restored the realm!" << std::endl;
-        std::cout << "Your memories have returned, and the" << std::endl;
-        std::cout << "Shadow Lord's curse is broken forever." << std::endl;
+        out << "         CONGRATULATIONS!\n";
+        out << "   You have restored the realm!\n";
+        out << "Your memories have returned, and the\n";
+        out << "Shadow Lord's curse is broken forever.\n";
     } else {
-        std::cout << "           GAME OVER" << std::endl;
-        std::cout << "   Your journey ends here..." << std::endl;
-        std::cout << "The realm remains shrouded in darkness." << std::endl;
-    }
-    std::cout << "========================================" << std::endl;
-    std::cout << "\nFinal Stats:" << std::endl;
-    std::cout << "Turns played: " << turnsPlayed << std::endl;
-    std::cout << "Memories recovered: " << (player ? player->hasMemory("You have defeated the Shadow Lord and restored balance to the realm!") : false) << std::endl;
-    std::cout << "\nThank you for playing Echoes of the Forgotten Realm!" << std::endl;
+        out << "           GAME OVER\n";
+        out << "   Your journey ends here...\n";
+        out << "The realm remains shrouded in darkness.\n";
+    }
+    out << "========================================\n";
+    out << "\nFinal Stats:\n";
+    out << "Turns played: " << turnsPlayed << '\n';
+    out << "Memories recovered: " << (player ? player->hasMemory(data->victoryMemory) : false) << '\n';
+    out << "\nThank you for playing Echoes of the Forgotten Realm!\n";
 }
 
-void GameEngine::populateWorld() {
-    // Create rooms
-    auto village = std::make_shared<Room>("village", "Wrecked Village", 
-        "You stand in the ruins of what was once a thriving village. Collapsed houses and broken carts litter the area. A sense of ancient tragedy hangs in the air.");
-    
-    auto forest = std::make_shared<Room>("forest", "Misty Forest", 
-        "Dense fog swirls between ancient trees. The forest feels alive with whispers of the past. Strange shadows dance between the branches.");
-    
-    auto temple = std::make_shared<Room>("temple", "Abandoned Temple", 
-        "Crumbling stone pillars support a partially collapsed roof. Ancient runes glow faintly on the walls, hinting at forgotten power.");
-    
-    auto cave = std::make_shared<Room>("cave", "Underground Cave", 
-        "Dark tunnels stretch into the depths. Water drips steadily from stalactites, echoing in the darkness. The air is cold and damp.");
-    
-    auto keep = std::make_shared<Room>("keep", "Ruined Keep", 
-        "The once-mighty fortress now lies in ruins. A throne room opens before you, where shadows seem to gather with unnatural purpose.");
-    
-    auto chamber = std::make_shared<Room>("chamber", "Hidden Chamber", 
-        "A secret chamber revealed by the ancient key. Mystical energy fills the air, and a portal of swirling darkness dominates the center.");
-    
-    // Set up connections
-    village->addExit("north", "forest");
-    village->addExit("east", "temple");
-    
-    forest->addExit("south", "village");
-    forest->addExit("north", "cave");
-    forest->addExit("east", "keep");
-    
-    temple->addExit("west", "village");
-    temple->addExit("north", "keep");
-    
-    cave->addExit("south", "forest");
-    cave->addExit("east", "keep");
-    
-    keep->addExit("west", "forest");
-    keep->addExit("south", "temple");
-    
-    chamber->addExit("south", "temple");
-    
-    // Add environmental hazards
-    cave->setHazard(Room::HazardType::COLD);
-    chamber->setHazard(Room::HazardType::CURSED);
-    
-    // Add items
-    village->addItem(std::make_shared<Item>("rusty sword", "An old but serviceable blade", Item::Type::WEAPON, 10, 5));
-    village->addItem(std::make_shared<Item>("health potion", "A small vial of red liquid", Item::Type::POTION, 25, 20));
-    
-    forest->addItem(std::make_shared<Item>("iron dagger", "A sharp, well-balanced dagger", Item::Type::WEAPON, 20, 3));
-    
-    temple->addItem(std::make_shared<Item>("ancient key", "An ornate key humming with power", Item::Type::KEY, 0, 0));
-    temple->addItem(std::make_shared<Item>("crystal shard", "A glowing fragment of pure energy", Item::Type::QUEST_ITEM, 100, 0));
-    
-    cave->addItem(std::make_shared<Item>("steel sword", "A finely crafted blade", Item::Type::WEAPON, 50, 8));
-    cave->addItem(std::make_shared<Item>("health potion", "A small vial of red liquid", Item::Type::POTION, 25, 20));
-    
-    chamber->addItem(std::make_shared<Item>("legendary blade", "The weapon of a forgotten hero", Item::Type::WEAPON, 200, 15));
-    
-    // Add enemies
-    keep->addEnemy(std::make_shared<Enemy>(Enemy::createBoss()));
-    
-    // Store rooms
-    rooms["village"] = village;
-    rooms["forest"] = forest;
-    rooms["temple"] = temple;
-    rooms["cave"] = cave;
-    rooms["keep"] = keep;
-    rooms["chamber"] = chamber;
+void GameEngine::populateWorld(World& target) {
+    // Rooms are built as they are visited
+    target = World(data);
 }
@@ -3,63 +3,199 @@
 #include "Room.h"
 #include "Enemy.h"
 #include "Item.h"
-#include <map>
+#include "World.h"
+#include "GameIO.h"
+#include "Random.h"
+#include "CommandParser.h"
+#include "FileManager.h"
 #include <string>
+#include <string_view>
 #include <memory>
 
+class JournalWriter;
+struct Journal;
+class Metrics;
+
 class GameEngine {
+public:
+    // What the session is waiting for; every blocking prompt is a state so
+    // a session can be driven one line at a time (see handleLine)
+    enum class InputState {
+        NAME,
+        COMMAND,
+        COMBAT_CHOICE,
+        COMBAT_ITEM,
+        QUIT_CONFIRM,
+        FINISHED
+    };
+
 private:
+    Renderer out;
+    InputState inputState;
+    Random rng;
+    std::shared_ptr<const GameData> data;
+    
+    // Reused for every line so parsing does not allocate
+    std::string lineBuffer;
+    Command command;
+    
     std::unique_ptr<Player> player;
-    std::map<std::string, std::shared_ptr<Room>> rooms;
-    std::shared_ptr<Room> currentRoom;
+    World world;
+    RoomId currentRoomId;
     bool gameRunning;
     bool gameWon;
     
     // Game state
     int turnsPlayed;
-    bool finalBossDefeated;
     
-    // File handling
-    void loadRooms();
-    void loadItems();
-    void populateWorld();
+    // Quest progress. Flags and memories changing are the only things that
+    // can win the game, so the win condition is checked when one changes
+    // rather than every turn.
+    enum class QuestFlag : FlagId {
+        BOSS_DEFEATED
+    };
+    static constexpr size_t QUEST_FLAG_COUNT = 1;
+    FlagSet questFlags;
+    void setQuestFlag(QuestFlag flag);
+    void recoverMemory(MemoryId memory);
+    
+    // Applies the content's trigger for event with item (NO_ITEM for
+    // ENTER) in the current room; false if there is none
+    bool fireTrigger(TriggerEvent event, ItemId item);
+    
+    // World construction from the shared game data
+    void populateWorld(World& target);
+    
+    // Save games: the last snapshot taken, mirrored to saveFile if set
+    std::string saveFile;
+    std::string savedGame;
+    
+    // Where input is recorded, if anywhere (see Journal)
+    std::unique_ptr<JournalWriter> journal;
+    
+    // Where handler timings and counters go, if anywhere; not owned, as
+    // the sessions of a server share one
+    Metrics* metrics;
+    // Whether the player may use admin commands such as "metrics"
+    bool admin;
     
     // Combat system
-    void handleCombat(std::shared_ptr<Enemy> enemy);
-    bool playerAttack(std::shared_ptr<Enemy> enemy);
-    bool enemyAttack(std::shared_ptr<Enemy> enemy);
+    EnemyId combatEnemy;
+    void handleCombat(EnemyId enemy);
+    void handleCombatChoice(const std::string& line);
+    void handleCombatItem(const std::string& line);
+    void continueCombat();
+    void promptCombat();
+    void endCombat();
+    bool playerAttack(EnemyId enemy);
+    bool enemyAttack(EnemyId enemy);
     
     // Input processing
-    std::vector<std::string> parseCommand(const std::string& input);
-    void processCommand(const std::vector<std::string>& command);
+    void handleName(const std::string& line);
+    void handleCommandLine(const std::string& line);
+    void processCommand(const Command& command);
     
     // Command handlers
-    void handleMove(const std::string& direction);
+    void handleMove(Direction direction);
+    void handleTravel(std::string_view destination);
     void handleLook();
-    void handleTake(const std::string& itemName);
-    void handleUse(const std::string& itemName);
-    void handleAttack(const std::string& target);
+    void handleTake(std::string_view itemName);
+    void handleUse(std::string_view itemName);
+    void handleAttack(std::string_view target);
     void handleInventory();
     void handleMemory();
     void handleSave();
     void handleLoad();
     void handleHelp();
     void handleQuit();
+    void handleQuitConfirm(const std::string& line);
+    void handleMetrics();
     
-    // Game logic
+    // Game logic. finishTurn() is advanceTurn() then endTurn(); travel
+    // advances the turn of each step itself. advanceTurn() dispatches the
+    // world's timed events that fall due.
+    void finishTurn();
+    bool advanceTurn();
+    void endTurn();
+    std::vector<TimedEvent> dueEvents;      // scratch for advanceTurn()
+    bool turnAdvanced;                      // by the command being handled
+    // Enemies in the room keep the player there; says so if they do
+    bool blockedByEnemies();
+    // Files the current room's hazard, if any, to hurt the player next turn
+    void scheduleHazard();
     void checkRoomHazards();
+    // A random encounter may appear in the current room
+    void rollEncounter();
     void checkWinCondition();
     void displayGameInfo();
-    std::string toLowerCase(const std::string& str);
+    // Forks: same state, new output, world shared copy-on-write
+    GameEngine(const GameEngine& other, OutputSink& output);
+    
+    const Room& currentRoom() const { return world.room(currentRoomId); }
+    Room& editCurrentRoom() { return world.editRoom(currentRoomId); }
     
 public:
-    GameEngine();
-    ~GameEngine() = default;
+    // Sessions with the same seed and stream replay identically
+    GameEngine(OutputSink& output, std::shared_ptr<const GameData> data, uint64_t seed, uint64_t stream = 0);
+    // Finishes the journal, if recording
+    ~GameEngine();
     
-    void startGame();
-    void gameLoop();
+    // Blocking drivers: play a whole session from an input source, or
+    // replay a recorded one (construct with the journal's seed and stream)
+    void startGame(InputSource& input);
+    void replay(const Journal& journal);
     void endGame(bool won);
     
+    // Non-blocking driver: the caller feeds lines as they arrive
+    void beginSession();
+    void handleLine(const std::string& line);
+    void endInput();
+    void flushOutput() { out.flushTurn(); }
+    bool isFinished() const { return inputState == InputState::FINISHED; }
+    InputState getInputState() const { return inputState; }
+    
     // Utility
     bool isGameRunning() const { return gameRunning; }
+    bool hasWon() const { return gameWon; }
+    int getTurnsPlayed() const { return turnsPlayed; }
+    int getPlayerHealth() const { return player ? player->getHealth() : 0; }
+    const World& getWorld() const { return world; }
+    RoomId getCurrentRoomId() const { return currentRoomId; }
+    
+    // Save games. saveState overwrites buffer with a versioned binary
+    // snapshot of the session, including the prompt it is waiting at, so
+    // a session parked mid-fight resumes mid-fight; reusing the buffer
+    // keeps checkpoints allocation free. loadState throws
+    // std::runtime_error on a bad or mismatched snapshot and leaves the
+    // session untouched.
+    void setSaveFile(const std::string& path) { saveFile = path; }
+    
+    // Records every line from now on; start before beginSession() for a
+    // journal that replays
+    void recordTo(std::unique_ptr<JournalWriter> writer);
+    // Times handlers and counts events into target from now on
+    void measureTo(Metrics* target) { metrics = target; }
+    // Lets the player use admin commands, which show data beyond their own
+    // session; for local sessions, never for the players of a server
+    void allowAdminCommands() { admin = true; }
+    void saveState(std::string& buffer) const;
+    void loadState(std::string_view snapshot);
+    // Renders the prompt the session is waiting at; drivers that restore
+    // a parked session with loadState() call it to ask again
+    void showPrompt();
+    
+    // Branches the session for lookahead: the fork renders to its own
+    // output and shares rooms, items and enemies with this session until
+    // either side changes them. Forks never write the save file, a
+    // journal or metrics.
+    std::unique_ptr<GameEngine> fork(OutputSink& output) const;
+    
+    // Search support (see Solver). step() plays one line with rendering
+    // switched off; legalCommands() lists the lines worth trying in the
+    // current state; stateHash() identifies states that play out the same
+    // given equal player health (RNG state and cosmetic details such as
+    // gold are left out).
+    void step(const std::string& line);
+    void legalCommands(std::vector<std::string>& commands) const;
+    uint64_t stateHash() const;
 };
@@ -0,0 +1,62 @@
+#include "GameIO.h"
+#include <fstream>
+#include <stdexcept>
+
+bool StreamInput::readLine(std::string& line) {
+    return static_cast<bool>(std::getline(in, line));
+}
+
+bool ScriptInput::readLine(std::string& line) {
+    if (nextLine >= lines.size()) {
+        return false;
+    }
+    line = lines[nextLine++];
+    return true;
+}
+
+void StreamSink::write(const char* data, size_t size) {
+    out.write(data, static_cast<std::streamsize>(size));
+    out.flush();
+}
+
+// The turn buffer is sized on first use, so silent sessions (forks, the
+// solver) never allocate one
+RenderBuffer::RenderBuffer(OutputSink& sink) : sink(sink) {}
+
+RenderBuffer::int_type RenderBuffer::overflow(int_type ch) {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        if (pending.capacity() < 4096) pending.reserve(4096);
+        pending.push_back(traits_type::to_char_type(ch));
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize RenderBuffer::xsputn(const char* data, std::streamsize size) {
+    if (pending.capacity() < 4096) pending.reserve(4096);
+    pending.append(data, static_cast<size_t>(size));
+    return size;
+}
+
+void RenderBuffer::flushTurn() {
+    if (!pending.empty()) {
+        sink.write(pending.data(), pending.size());
+        pending.clear();
+    }
+}
+
+std::vector<std::string> loadScript(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Cannot open script file: " + filename);
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
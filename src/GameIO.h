@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <cstddef>
+
+// Where a session reads its commands from
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    // Reads the next line, returns false once the source is exhausted
+    virtual bool readLine(std::string& line) = 0;
+};
+
+// Reads lines from a stream (std::cin for interactive play)
+class StreamInput : public InputSource {
+private:
+    std::istream& in;
+
+public:
+    explicit StreamInput(std::istream& in) : in(in) {}
+    bool readLine(std::string& line) override;
+};
+
+// Replays an in-memory command buffer; the lines can be shared by many sessions
+class ScriptInput : public InputSource {
+private:
+    const std::vector<std::string>& lines;
+    size_t nextLine;
+
+public:
+    explicit ScriptInput(const std::vector<std::string>& lines) : lines(lines), nextLine(0) {}
+    bool readLine(std::string& line) override;
+};
+
+// Where a session writes its text
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+    virtual void write(const char* data, size_t size) = 0;
+};
+
+// Forwards output to a stream (std::cout for interactive play), one flush per write
+class StreamSink : public OutputSink {
+private:
+    std::ostream& out;
+
+public:
+    explicit StreamSink(std::ostream& out) : out(out) {}
+    void write(const char* data, size_t size) override;
+};
+
+// Captures output in memory, used by scripted sessions
+class StringSink : public OutputSink {
+private:
+    std::string text;
+
+public:
+    void write(const char* data, size_t size) override { text.append(data, size); }
+    const std::string& str() const { return text; }
+    void clear() { text.clear(); }
+};
+
+// Discards output, used for benchmark runs; only counts the bytes
+class NullSink : public OutputSink {
+private:
+    size_t bytes;
+
+public:
+    NullSink() : bytes(0) {}
+    void write(const char*, size_t size) override { bytes += size; }
+    size_t bytesWritten() const { return bytes; }
+};
+
+// Stream buffer that collects a turn's worth of text in memory.
+// Nothing reaches the sink until flushTurn(), so std::flush / std::endl
+// cannot turn into a write per line.
+class RenderBuffer : public std::streambuf {
+private:
+    OutputSink& sink;
+    std::string pending;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize size) override;
+    int sync() override { return 0; }
+
+public:
+    explicit RenderBuffer(OutputSink& sink);
+    void flushTurn();
+};
+
+// Per-session render layer: an std::ostream over a RenderBuffer so game
+// objects keep using operator<<, flushed once per turn by GameEngine
+class Renderer : public std::ostream {
+private:
+    RenderBuffer buffer;
+
+public:
+    explicit Renderer(OutputSink& sink) : std::ostream(nullptr), buffer(sink) { rdbuf(&buffer); }
+    void flushTurn() { buffer.flushTurn(); }
+};
+
+// Loads a command script into memory, one command per line
+std::vector<std::string> loadScript(const std::string& filename);
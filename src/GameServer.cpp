@@ -0,0 +1,340 @@
+#include "GameServer.h"
+#include "Journal.h"
+#include <stdexcept>
+#include <iostream>
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+const size_t MAX_LINE_LENGTH = 4096;
+// Replies a client may leave unread before the server stops running its
+// commands
+const size_t MAX_UNSENT = 64 * 1024;
+const int MAX_EVENTS = 256;
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+GameServer::Session::Session(int fd) : fd(fd), sent(0), wantsWrite(false), reading(true), events(0) {}
+
+GameServer::GameServer(const std::string& address, std::shared_ptr<const GameData> data, uint64_t seed)
+    : address(address), data(std::move(data)), seed(seed), nextStream(0), metrics(nullptr), listenFd(-1), epollFd(-1) {}
+
+GameServer::~GameServer() {
+    for (auto& entry : sessions) {
+        ::close(entry.first);
+    }
+    if (listenFd >= 0) ::close(listenFd);
+    if (epollFd >= 0) ::close(epollFd);
+    if (!unixPath.empty()) ::unlink(unixPath.c_str());
+}
+
+void GameServer::openListener() {
+    if (address.compare(0, 4, "tcp:") == 0) {
+        int port = std::stoi(address.substr(4));
+        listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw systemError("socket");
+
+        int reuse = 1;
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw systemError("bind " + address);
+        }
+    }
+    else if (address.compare(0, 5, "unix:") == 0) {
+        unixPath = address.substr(5);
+        sockaddr_un addr{};
+        if (unixPath.empty() || unixPath.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Invalid unix socket path: " + unixPath);
+        }
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw systemError("socket");
+
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(unixPath.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw systemError("bind " + address);
+        }
+    }
+    else {
+        throw std::runtime_error("Server address must be tcp:PORT or unix:PATH, got: " + address);
+    }
+
+    if (::listen(listenFd, SOMAXCONN) < 0) throw systemError("listen");
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) throw systemError("epoll_create1");
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) throw systemError("epoll_ctl");
+}
+
+void GameServer::run() {
+    openListener();
+
+    // No SA_RESTART so epoll_wait wakes up with EINTR on shutdown
+    struct sigaction action{};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cerr << "Listening on " << address << std::endl;
+
+    epoll_event events[MAX_EVENTS];
+    while (!stopRequested) {
+        // Wake up in time for the next metrics dump even when idle
+        int timeout = metrics ? metrics->millisecondsUntilDump() : -1;
+        int count = ::epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("epoll_wait");
+        }
+        if (metrics) {
+            metrics->dumpIfDue();
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+
+            auto it = sessions.find(fd);
+            if (it == sessions.end()) continue;
+            Session& session = *it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeSession(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                readFrom(session);
+            }
+            else if (events[i].events & EPOLLOUT) {
+                writeTo(session);
+            }
+        }
+    }
+
+    std::cerr << "Server stopped with " << sessions.size() << " open sessions" << std::endl;
+}
+
+void GameServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            // Out of descriptors and the like: leave the rest in the backlog
+            std::cerr << "accept: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        if (unixPath.empty()) {
+            int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+
+        auto session = std::make_unique<Session>(fd);
+        session->events = event.events;
+        uint64_t stream = nextStream++;
+        session->game = std::make_unique<GameEngine>(session->outbox, data, seed, stream);
+        session->game->measureTo(metrics);
+        if (!journalDirectory.empty()) {
+            std::string path = journalDirectory + "/session-" + std::to_string(stream) + ".journal";
+            try {
+                session->game->recordTo(std::make_unique<JournalWriter>(path, *data, seed, stream));
+            } catch (const std::runtime_error& e) {
+                // A session is worth more than its journal
+                std::cerr << e.what() << std::endl;
+            }
+        }
+        session->game->beginSession();
+        session->game->flushOutput();
+
+        Session& added = *session;
+        sessions[fd] = std::move(session);
+        writeTo(added);
+    }
+}
+
+bool GameServer::feedLines(Session& session) {
+    // Feed every complete line to the session's state machine, as long as
+    // the client keeps up with the replies
+    size_t start = 0;
+    while (!session.game->isFinished() && session.unsent() <= MAX_UNSENT) {
+        size_t end = session.inbox.find('\n', start);
+        if (end == std::string::npos) break;
+
+        size_t length = end - start;
+        if (length > 0 && session.inbox[end - 1] == '\r') length--;
+        if (length > MAX_LINE_LENGTH) return false;
+        session.game->handleLine(session.inbox.substr(start, length));
+        session.game->flushOutput();
+        start = end + 1;
+    }
+    session.inbox.erase(0, start);
+
+    // A partial line can only grow, so a long one is refused as it arrives;
+    // lines held back for a slow reader are complete and don't count
+    size_t partial = session.inbox.size() - (session.inbox.rfind('\n') + 1);
+    return partial <= MAX_LINE_LENGTH;
+}
+
+void GameServer::readFrom(Session& session) {
+    char buffer[4096];
+    bool peerClosed = false;
+
+    while (true) {
+        if (!feedLines(session)) {
+            closeSession(session.fd);
+            return;
+        }
+        if (session.game->isFinished()) break;
+        if (session.unsent() > MAX_UNSENT) {
+            // Carry on with the lines held back if the client takes the
+            // replies straight away; otherwise wait for it on EPOLLOUT
+            if (!sendPending(session)) return;
+            if (session.unsent() > MAX_UNSENT) break;
+            continue;
+        }
+
+        ssize_t received = ::recv(session.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            session.inbox.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received == 0) {
+            peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeSession(session.fd);
+        return;
+    }
+
+    if (peerClosed) {
+        session.game->endInput();
+        session.game->flushOutput();
+    }
+    if (!sendPending(session)) return;
+    updateInterest(session);
+}
+
+bool GameServer::sendPending(Session& session) {
+    const std::string& pending = session.outbox.str();
+
+    while (session.sent < pending.size()) {
+        ssize_t written = ::send(session.fd, pending.data() + session.sent,
+                                 pending.size() - session.sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            session.sent += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            session.wantsWrite = true;
+            return true;
+        }
+        closeSession(session.fd);
+        return false;
+    }
+
+    session.outbox.clear();
+    session.sent = 0;
+    session.wantsWrite = false;
+
+    if (session.game->isFinished()) {
+        closeSession(session.fd);
+        return false;
+    }
+    return true;
+}
+
+void GameServer::writeTo(Session& session) {
+    if (!sendPending(session)) return;
+    if (!session.reading && session.unsent() <= MAX_UNSENT) {
+        // Caught up: run the commands held back, then read again
+        readFrom(session);
+        return;
+    }
+    updateInterest(session);
+}
+
+void GameServer::updateInterest(Session& session) {
+    // Reading stops while the client leaves too many replies unread, and
+    // once the game is over
+    session.reading = !session.game->isFinished() && session.unsent() <= MAX_UNSENT;
+    uint32_t wanted = session.reading ? EPOLLIN | EPOLLRDHUP : 0;
+    if (session.wantsWrite) wanted |= EPOLLOUT;
+    if (wanted == session.events) return;
+
+    session.events = wanted;
+    epoll_event event{};
+    event.events = wanted;
+    event.data.fd = session.fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, session.fd, &event);
+}
+
+void GameServer::closeSession(int fd) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    sessions.erase(fd);
+}
+
+#else
+
+GameServer::Session::Session(int fd) : fd(fd), sent(0), wantsWrite(false), reading(true), events(0) {}
+
+GameServer::GameServer(const std::string& address, std::shared_ptr<const GameData> data, uint64_t seed)
+    : address(address), data(std::move(data)), seed(seed), nextStream(0), metrics(nullptr), listenFd(-1), epollFd(-1) {}
+
+GameServer::~GameServer() = default;
+
+void GameServer::run() {
+    throw std::runtime_error("Server mode requires Linux (epoll)");
+}
+
+#endif
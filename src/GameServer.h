@@ -0,0 +1,63 @@
+#pragma once
+#include "GameEngine.h"
+#include "GameIO.h"
+#include "Metrics.h"
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+// Hosts one GameEngine session per connection on a single epoll event loop.
+// Listens on "tcp:PORT" (loopback only) or "unix:PATH".
+class GameServer {
+private:
+    struct Session {
+        int fd;
+        std::string inbox;      // bytes received but not yet a full line
+        StringSink outbox;      // rendered text waiting to be sent
+        size_t sent;            // how much of outbox already went out
+        bool wantsWrite;        // has output waiting for the socket
+        bool reading;           // false while the client leaves its replies unread
+        uint32_t events;        // what epoll is watching for
+        std::unique_ptr<GameEngine> game;
+
+        explicit Session(int fd);
+        size_t unsent() const { return outbox.str().size() - sent; }
+    };
+
+    std::string address;
+    std::shared_ptr<const GameData> data;   // shared by every session
+    uint64_t seed;
+    uint64_t nextStream;    // each connection gets its own RNG stream
+    std::string journalDirectory;
+    Metrics* metrics;
+    int listenFd;
+    int epollFd;
+    std::string unixPath;
+    std::unordered_map<int, std::unique_ptr<Session>> sessions;
+
+    void openListener();
+    void acceptConnections();
+    bool feedLines(Session& session);
+    void readFrom(Session& session);
+    bool sendPending(Session& session);
+    void writeTo(Session& session);
+    void updateInterest(Session& session);
+    void closeSession(int fd);
+
+public:
+    GameServer(const std::string& address, std::shared_ptr<const GameData> data, uint64_t seed);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Records each session to DIRECTORY/session-STREAM.journal
+    void setJournalDirectory(const std::string& directory) { journalDirectory = directory; }
+    // Every session reports into metrics, which the server also dumps on
+    // schedule (see Metrics::setDumpFile)
+    void setMetrics(Metrics* target) { metrics = target; }
+
+    // Serves connections until interrupted (SIGINT/SIGTERM)
+    void run();
+};
@@ -0,0 +1,100 @@
+#include "Inventory.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+#include <algorithm>
+
+namespace {
+
+// Saves hold the stacks in pickup order, which loading renumbers
+struct SavedStack {
+    ItemId item;
+    uint32_t count;
+};
+
+} // namespace
+
+Inventory::Inventory() : nextPickup(0) {
+    equipped.fill(NO_ITEM);
+}
+
+void Inventory::add(ItemId item, uint32_t count) {
+    if (item >= stackOf.size()) {
+        stackOf.resize(item + 1, NO_STACK);
+    }
+    if (stackOf[item] != NO_STACK) {
+        stacks[stackOf[item]].count += count;
+        return;
+    }
+    stackOf[item] = static_cast<uint32_t>(stacks.size());
+    stacks.push_back({item, count, nextPickup++});
+}
+
+bool Inventory::remove(ItemId item) {
+    if (count(item) == 0) return false;
+
+    uint32_t index = stackOf[item];
+    if (--stacks[index].count > 0) return true;
+
+    // Empty stacks are swapped out with the last one; pickup numbers keep
+    // the listing order
+    stackOf[stacks.back().item] = index;
+    stacks[index] = stacks.back();
+    stacks.pop_back();
+    stackOf[item] = NO_STACK;
+    return true;
+}
+
+void Inventory::stacksInPickupOrder(std::vector<Stack>& ordered) const {
+    ordered = stacks;
+    std::sort(ordered.begin(), ordered.end(), [](const Stack& a, const Stack& b) { return a.pickup < b.pickup; });
+}
+
+void Inventory::clear() {
+    stacks.clear();
+    stackOf.clear();
+    equipped.fill(NO_ITEM);
+    nextPickup = 0;
+}
+
+void Inventory::saveState(SnapshotWriter& writer) const {
+    std::vector<Stack> ordered;
+    stacksInPickupOrder(ordered);
+    std::vector<SavedStack> saved;
+    saved.reserve(ordered.size());
+    for (const Stack& stack : ordered) {
+        saved.push_back({stack.item, stack.count});
+    }
+    writer.writeArray(saved);
+    for (ItemId item : equipped) {
+        writer.write(item);
+    }
+}
+
+void Inventory::loadState(SnapshotReader& reader, size_t itemCount) {
+    std::vector<SavedStack> loaded;
+    reader.readArray(loaded);
+
+    clear();
+    for (const SavedStack& stack : loaded) {
+        if (stack.item >= itemCount) SnapshotReader::fail("save refers to an unknown item");
+        if (stack.count == 0 || contains(stack.item)) SnapshotReader::fail("save has a malformed inventory");
+        add(stack.item, stack.count);
+    }
+    for (ItemId& item : equipped) {
+        item = reader.read<ItemId>();
+        if (item != NO_ITEM && item >= itemCount) SnapshotReader::fail("save refers to an unknown item");
+    }
+}
+
+uint64_t Inventory::hashState() const {
+    // Summed so the order of the stacks does not matter
+    uint64_t stackSum = 0;
+    for (const Stack& stack : stacks) {
+        stackSum += hashMix(stack.item, stack.count);
+    }
+    uint64_t hash = hashMix(0, stackSum);
+    for (ItemId item : equipped) {
+        hash = hashMix(hash, item);
+    }
+    return hash;
+}
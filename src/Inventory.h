@@ -0,0 +1,68 @@
+#pragma once
+#include "Item.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Places an item can be equipped to
+enum class EquipSlot : uint8_t {
+    WEAPON
+};
+
+const size_t EQUIP_SLOT_COUNT = 1;
+
+// A player's items as stacks of interned ItemIds: two health potions are
+// one stack with a count of two. Stacks sit in a dense array with an
+// ItemId-indexed table pointing into it, so finding, adding and removing
+// an item are O(1) and never compare names. Removal swaps the last stack
+// into the gap, so each stack keeps a pickup number, and listings sort by
+// it.
+class Inventory {
+public:
+    struct Stack {
+        ItemId item;
+        uint32_t count;
+        uint32_t pickup;    // order the stack was started in
+    };
+
+private:
+    static constexpr uint32_t NO_STACK = UINT32_MAX;
+
+    std::vector<Stack> stacks;         // in no particular order
+    std::vector<uint32_t> stackOf;     // by ItemId: index into stacks, or NO_STACK
+    std::array<ItemId, EQUIP_SLOT_COUNT> equipped;
+    uint32_t nextPickup;
+
+public:
+    Inventory();
+
+    void add(ItemId item, uint32_t count = 1);
+    // Takes one of an item; false if there is none
+    bool remove(ItemId item);
+    uint32_t count(ItemId item) const {
+        return item < stackOf.size() && stackOf[item] != NO_STACK ? stacks[stackOf[item]].count : 0;
+    }
+    bool contains(ItemId item) const { return count(item) > 0; }
+    bool empty() const { return stacks.empty(); }
+    const std::vector<Stack>& getStacks() const { return stacks; }
+    // The stacks in pickup order, for listing
+    void stacksInPickupOrder(std::vector<Stack>& ordered) const;
+
+    // Equipment. Equipping does not take the item out of the inventory.
+    void equip(EquipSlot slot, ItemId item) { equipped[static_cast<size_t>(slot)] = item; }
+    ItemId getEquipped(EquipSlot slot) const { return equipped[static_cast<size_t>(slot)]; }
+
+    void clear();
+
+    // Binary save games. itemCount is the size of the game's item list, to
+    // reject saves naming items it does not have.
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader, size_t itemCount);
+
+    // Independent of the order things were picked up in
+    uint64_t hashState() const;
+};
@@ -1,7 +1,7 @@
 #include "Item.h"
 
 Item::Item(const std::string& name, const std::string& description, Type type, int value, int effect)
-    : name(name), description(description), type(type), value(value), effect(effect) {}
+    : name(name), description(description), type(type), value(value), effect(effect), id(NO_ITEM) {}
 
 std::string Item::getTypeString() const {
     switch (type) {
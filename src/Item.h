@@ -3,6 +3,11 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <cstdint>
+
+// Items are interned to their index in the game data's item list
+using ItemId = uint32_t;
+const ItemId NO_ITEM = UINT32_MAX;
 
 class Item {
 public:
@@ -20,6 +25,7 @@ private:
     Type type;
     int value;
     int effect; // damage for weapons, healing for potions, etc.
+    ItemId id;
 
 public:
     Item(const std::string& name, const std::string& description, Type type, int value = 0, int effect = 0);
@@ -30,6 +36,8 @@ public:
     Type getType() const { return type; }
     int getValue() const { return value; }
     int getEffect() const { return effect; }
+    ItemId getId() const { return id; }
+    void setId(ItemId itemId) { id = itemId; }
     
     // Utility
     std::string getTypeString() const;
@@ -0,0 +1,101 @@
+#include "Journal.h"
+#include "FileManager.h"
+#include "Snapshot.h"
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+// "EFRJ" followed by the format version
+const uint32_t JOURNAL_MAGIC = 0x4A524645;
+const uint32_t JOURNAL_VERSION = 1;
+
+// Take the place of a line length to mark the other kinds of record
+const uint32_t END_RECORD = UINT32_MAX;
+const uint32_t SNAPSHOT_RECORD = UINT32_MAX - 1;
+
+} // namespace
+
+JournalWriter::JournalWriter(const std::string& path, const GameData& data, uint64_t seed, uint64_t stream)
+    : file(path, std::ios::binary | std::ios::trunc) {
+    if (!file) {
+        throw std::runtime_error("Cannot create journal: " + path);
+    }
+
+    SnapshotWriter writer(buffer);
+    writer.write(JOURNAL_MAGIC);
+    writer.write(JOURNAL_VERSION);
+    writer.write(data.fingerprint);
+    writer.write(seed);
+    writer.write(stream);
+    writeBuffer();
+}
+
+void JournalWriter::writeBuffer() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    buffer.clear();
+}
+
+void JournalWriter::record(std::string_view line) {
+    SnapshotWriter writer(buffer);
+    writer.writeString(line);
+    writeBuffer();
+}
+
+void JournalWriter::recordSnapshot(std::string_view snapshot) {
+    SnapshotWriter writer(buffer);
+    writer.write(SNAPSHOT_RECORD);
+    writer.writeString(snapshot);
+    writeBuffer();
+}
+
+void JournalWriter::finish(int turnsPlayed, bool won) {
+    SnapshotWriter writer(buffer);
+    writer.write(END_RECORD);
+    writer.write<int32_t>(turnsPlayed);
+    writer.write<uint8_t>(won);
+    writeBuffer();
+}
+
+Journal Journal::load(const std::string& path, const GameData& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open journal: " + path);
+    }
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    try {
+        SnapshotReader reader(contents);
+        if (reader.read<uint32_t>() != JOURNAL_MAGIC) SnapshotReader::fail("not a journal");
+        if (reader.read<uint32_t>() != JOURNAL_VERSION) SnapshotReader::fail("journal is from a different version of the game");
+        if (reader.read<uint64_t>() != data.fingerprint) SnapshotReader::fail("journal was recorded with different game data");
+
+        Journal journal{};
+        journal.seed = reader.read<uint64_t>();
+        journal.stream = reader.read<uint64_t>();
+        while (!reader.atEnd()) {
+            // A line's length, or the marker of another kind of record
+            SnapshotReader record = reader;
+            uint32_t kind = record.read<uint32_t>();
+            if (kind == END_RECORD) {
+                journal.finished = true;
+                journal.turnsPlayed = record.read<int32_t>();
+                journal.won = record.read<uint8_t>() != 0;
+                if (!record.atEnd()) SnapshotReader::fail("records after the end of the journal");
+                break;
+            }
+            if (kind == SNAPSHOT_RECORD) {
+                if (journal.entries.empty()) SnapshotReader::fail("snapshot before any line");
+                journal.entries.back().snapshot.emplace(record.readString());
+                reader = record;
+                continue;
+            }
+            journal.entries.push_back({std::string(reader.readString()), std::nullopt});
+        }
+        return journal;
+    }
+    catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <fstream>
+#include <cstdint>
+
+struct GameData;
+
+// Session journals: the RNG seed and stream of a session and every line
+// of input it received, which is all it takes to replay it exactly. A save
+// file loaded from disk is input too, so it is recorded with the line that
+// loaded it. The format is binary like save games: a header naming the
+// game data, one length-prefixed record per line or snapshot, and an end
+// record with the outcome so a replay can check it came out the same.
+
+// Appends to a journal as the session runs. Each line is flushed as it is
+// recorded, so a journal survives the process dying mid-session.
+class JournalWriter {
+private:
+    std::ofstream file;
+    std::string buffer;     // reused for every record
+
+    void writeBuffer();
+
+public:
+    // Throws std::runtime_error if the file cannot be created
+    JournalWriter(const std::string& path, const GameData& data, uint64_t seed, uint64_t stream);
+
+    void record(std::string_view line);
+    // Save data the last recorded line read from outside the session
+    void recordSnapshot(std::string_view snapshot);
+    // Writes the end record; nothing may be recorded after it
+    void finish(int turnsPlayed, bool won);
+};
+
+// A journal read back for replay
+struct Journal {
+    struct Entry {
+        std::string line;
+        std::optional<std::string> snapshot;   // save file contents the line loaded
+    };
+
+    uint64_t seed;
+    uint64_t stream;
+    std::vector<Entry> entries;
+    bool finished;          // has an end record; the session may have died otherwise
+    int turnsPlayed;        // outcome from the end record
+    bool won;
+
+    // Throws std::runtime_error on a malformed journal or one recorded
+    // with different game data
+    static Journal load(const std::string& path, const GameData& data);
+};
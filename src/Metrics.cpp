@@ -0,0 +1,217 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+const char* const HANDLER_NAMES[Metrics::HANDLER_COUNT] = {
+    "start", "move", "travel", "look", "take", "use", "attack", "combat", "inventory",
+    "memory", "save", "load", "help", "quit", "status", "unknown", "turn"
+};
+
+const char* const COUNTER_NAMES[Metrics::COUNTER_COUNT] = {
+    "sessions", "turns", "encounters", "combats", "deaths", "wins"
+};
+
+double microseconds(uint64_t nanoseconds) {
+    return nanoseconds / 1000.0;
+}
+
+} // namespace
+
+uint64_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// Every plain new and new[] comes through here; the other forms of
+// operator new call these by default
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+LatencyHistogram::LatencyHistogram() : total(0), sum(0), largest(0) {
+    buckets.fill(0);
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    const uint64_t limit = (uint64_t(1) << MAX_BITS) - 1;
+    if (value > limit) value = limit;
+    if (value < SUB_COUNT) return static_cast<size_t>(value);
+
+    // The top SUB_BITS bits below the leading one pick the sub-bucket
+    unsigned shift = 63 - __builtin_clzll(value) - SUB_BITS;
+    return static_cast<size_t>((shift + 1) * SUB_COUNT + ((value >> shift) - SUB_COUNT));
+}
+
+uint64_t LatencyHistogram::highestIn(size_t bucket) {
+    if (bucket < SUB_COUNT) return bucket;
+    unsigned shift = static_cast<unsigned>(bucket / SUB_COUNT - 1);
+    uint64_t lowest = (SUB_COUNT + bucket % SUB_COUNT) << shift;
+    return lowest + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    ++buckets[bucketOf(nanoseconds)];
+    ++total;
+    sum += nanoseconds;
+    if (nanoseconds > largest) largest = nanoseconds;
+}
+
+uint64_t LatencyHistogram::valueAt(double percentile) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total));
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            return std::min(highestIn(bucket), largest);
+        }
+    }
+    return largest;
+}
+
+Metrics::Metrics(uint32_t sampleEvery)
+    : sampleEvery(sampleEvery > 0 ? sampleEvery : 1), started(Clock::now()),
+      dumpInterval(Clock::duration::zero()) {
+    untilSample.fill(1);
+    calls.fill(0);
+    counters.fill(0);
+}
+
+void Metrics::record(Handler handler, Clock::duration elapsed) {
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    latencies[static_cast<size_t>(handler)].record(static_cast<uint64_t>(nanoseconds));
+}
+
+void Metrics::report(std::ostream& out) const {
+    double uptime = std::chrono::duration<double>(Clock::now() - started).count();
+
+    out << "\n=== METRICS ===\n";
+    out << std::fixed << std::setprecision(1) << "Uptime: " << uptime << " s\n";
+    for (size_t counter = 0; counter < COUNTER_COUNT; ++counter) {
+        out << COUNTER_NAMES[counter] << ": " << counters[counter] << '\n';
+    }
+    out << "allocations: " << allocationCount() << '\n';
+
+    out << "\nLatency in us, one call in " << sampleEvery << " timed:\n";
+    out << std::left << std::setw(11) << "handler" << std::right << std::setw(10) << "calls"
+        << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "max" << '\n';
+    for (size_t handler = 0; handler < HANDLER_COUNT; ++handler) {
+        if (calls[handler] == 0) continue;
+        const LatencyHistogram& histogram = latencies[handler];
+        out << std::left << std::setw(11) << HANDLER_NAMES[handler] << std::right << std::setw(10) << calls[handler]
+            << std::setw(9) << microseconds(histogram.valueAt(50))
+            << std::setw(9) << microseconds(histogram.valueAt(90))
+            << std::setw(9) << microseconds(histogram.valueAt(99))
+            << std::setw(9) << microseconds(histogram.max()) << '\n';
+    }
+    out << "===============\n";
+    out << std::defaultfloat;
+}
+
+void Metrics::writeJson(std::ostream& out) const {
+    double uptime = std::chrono::duration<double>(Clock::now() - started).count();
+
+    out << "{\n  \"uptime_seconds\": " << std::fixed << std::setprecision(3) << uptime
+        << ",\n  \"sample_every\": " << sampleEvery
+        << ",\n  \"allocations\": " << allocationCount()
+        << ",\n  \"counters\": {";
+    for (size_t counter = 0; counter < COUNTER_COUNT; ++counter) {
+        out << (counter ? ", " : "") << '"' << COUNTER_NAMES[counter] << "\": " << counters[counter];
+    }
+    out << "},\n  \"handlers\": {\n";
+    bool first = true;
+    for (size_t handler = 0; handler < HANDLER_COUNT; ++handler) {
+        if (calls[handler] == 0) continue;
+        const LatencyHistogram& histogram = latencies[handler];
+        out << (first ? "" : ",\n") << "    \"" << HANDLER_NAMES[handler] << "\": {"
+            << "\"calls\": " << calls[handler]
+            << ", \"sampled\": " << histogram.count()
+            << ", \"mean_ns\": " << std::setprecision(0) << histogram.mean()
+            << ", \"p50_ns\": " << histogram.valueAt(50)
+            << ", \"p90_ns\": " << histogram.valueAt(90)
+            << ", \"p99_ns\": " << histogram.valueAt(99)
+            << ", \"max_ns\": " << histogram.max() << "}";
+        first = false;
+    }
+    out << "\n  }\n}\n";
+}
+
+void Metrics::setDumpFile(const std::string& path, std::chrono::seconds interval) {
+    dumpFile = path;
+    dumpInterval = interval;
+    nextDump = Clock::now() + dumpInterval;
+}
+
+void Metrics::dumpIfDue() {
+    if (dumpFile.empty()) return;
+    auto now = Clock::now();
+    if (now < nextDump) return;
+    nextDump = now + dumpInterval;
+
+    try {
+        dump();
+    } catch (const std::runtime_error& e) {
+        // Losing a dump is no reason to stop the game
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void Metrics::dump() const {
+    if (dumpFile.empty()) return;
+
+    // Written beside the target and renamed over it
+    std::string temporary = dumpFile + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        writeJson(file);
+        if (!file.flush()) {
+            throw std::runtime_error("Cannot write metrics: " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), dumpFile.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace metrics file: " + dumpFile);
+    }
+}
+
+int Metrics::millisecondsUntilDump() const {
+    if (dumpFile.empty()) return -1;
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(nextDump - Clock::now()).count();
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
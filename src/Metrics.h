@@ -0,0 +1,166 @@
+#pragma once
+#include <array>
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+// Heap allocations made by this process so far. The global operator new is
+// replaced (see Metrics.cpp) to count them; counting is one relaxed atomic
+// add per allocation.
+uint64_t allocationCount();
+
+// Latency histogram in the style of HdrHistogram: values fall into
+// power-of-two ranges split into 16 linear sub-buckets, so every recorded
+// value is known to within 1/16 of itself, from 1 ns up to about 18
+// minutes, in a fixed few kilobytes. Recording is an index computation and
+// an increment.
+class LatencyHistogram {
+private:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+    static constexpr unsigned MAX_BITS = 40;    // larger values are clamped
+    static constexpr size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    std::array<uint64_t, BUCKET_COUNT> buckets;
+    uint64_t total;
+    uint64_t sum;
+    uint64_t largest;
+
+    static size_t bucketOf(uint64_t value);
+    // The largest value that lands in a bucket
+    static uint64_t highestIn(size_t bucket);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t nanoseconds);
+    uint64_t count() const { return total; }
+    uint64_t max() const { return largest; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+    // Smallest value at or below which percentile % of the recorded values
+    // fall, rounded up to its bucket; 0 if nothing was recorded
+    uint64_t valueAt(double percentile) const;
+};
+
+// Runtime metrics shared by the sessions of a process: call counts and
+// latency histograms for every command handler, and game counters. Not
+// thread safe; the sessions that share one must run on one thread (the
+// server's event loop does).
+//
+// Reading the clock costs about as much as a cheap command, so only one
+// call in sampleEvery of each handler is timed, starting with the first:
+// histograms hold a uniform sample, while call counts and counters are
+// exact.
+class Metrics {
+public:
+    enum class Handler : uint8_t {
+        START,      // entering a name and populating the world
+        MOVE,
+        TRAVEL,
+        LOOK,
+        TAKE,
+        USE,
+        ATTACK,
+        COMBAT,     // a combat round or item
+        INVENTORY,
+        MEMORY,
+        SAVE,
+        LOAD,
+        HELP,
+        QUIT,
+        STATUS,
+        UNKNOWN,
+        TURN        // the world's turn after a command
+    };
+    static constexpr size_t HANDLER_COUNT = 17;
+
+    enum class Counter : uint8_t {
+        SESSIONS,
+        TURNS,
+        ENCOUNTERS,
+        COMBATS,
+        DEATHS,
+        WINS
+    };
+    static constexpr size_t COUNTER_COUNT = 6;
+
+    using Clock = std::chrono::steady_clock;
+
+    // Counts a handler call and times it if it is sampled. Does nothing
+    // without a Metrics, so callers need not check.
+    class Timer {
+    private:
+        Metrics* metrics;
+        Handler handler;
+        bool timed;
+        Clock::time_point start;
+
+    public:
+        Timer(Metrics* metrics, Handler handler);
+        ~Timer();
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+private:
+    std::array<LatencyHistogram, HANDLER_COUNT> latencies;
+    std::array<uint64_t, HANDLER_COUNT> calls;
+    std::array<uint64_t, COUNTER_COUNT> counters;
+    uint32_t sampleEvery;
+    std::array<uint32_t, HANDLER_COUNT> untilSample;
+    Clock::time_point started;
+
+    // Periodic dumps, if a file is set
+    std::string dumpFile;
+    Clock::duration dumpInterval;
+    Clock::time_point nextDump;
+
+    bool sample(Handler handler) {
+        uint32_t& until = untilSample[static_cast<size_t>(handler)];
+        if (--until > 0) return false;
+        until = sampleEvery;
+        return true;
+    }
+    void record(Handler handler, Clock::duration elapsed);
+
+public:
+    explicit Metrics(uint32_t sampleEvery = 16);
+
+    void increment(Counter counter) { ++counters[static_cast<size_t>(counter)]; }
+    uint64_t get(Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+    uint64_t callCount(Handler handler) const { return calls[static_cast<size_t>(handler)]; }
+    const LatencyHistogram& latency(Handler handler) const { return latencies[static_cast<size_t>(handler)]; }
+
+    // The metrics as a table for people, and as JSON for tools
+    void report(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+
+    // Dumps the JSON to path every interval; the file is replaced whole so
+    // readers never see half a dump. dumpIfDue() reads the clock, so it
+    // belongs after I/O rather than in a hot loop.
+    void setDumpFile(const std::string& path, std::chrono::seconds interval);
+    void dumpIfDue();
+    // Throws std::runtime_error if the file cannot be written
+    void dump() const;
+    // How long an event loop may sleep before the next dump, or -1 for
+    // no limit
+    int millisecondsUntilDump() const;
+};
+
+inline Metrics::Timer::Timer(Metrics* metrics, Handler handler)
+    : metrics(metrics), handler(handler), timed(false) {
+    if (!metrics) return;
+    ++metrics->calls[static_cast<size_t>(handler)];
+    if (metrics->sample(handler)) {
+        timed = true;
+        start = Clock::now();
+    }
+}
+
+inline Metrics::Timer::~Timer() {
+    if (timed) {
+        metrics->record(handler, Clock::now() - start);
+    }
+}
@@ -1,121 +1,117 @@
 #include "Player.h"
-#include <iostream>
+#include "FileManager.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+#include <ostream>
 #include <algorithm>
-#include <sstream>
 
-Player::Player(const std::string& name) 
-    : name(name), health(100), maxHealth(100), attack(10), defense(5), gold(50), equippedWeapon(nullptr) {}
+Player::Player(const std::string& name, const GameData& data) 
+    : name(name), health(100), maxHealth(100), attack(10), defense(5), gold(50), data(&data) {}
 
 int Player::getAttack() const {
     int totalAttack = attack;
-    if (equippedWeapon) {
-        totalAttack += equippedWeapon->getEffect();
+    if (const Item* weapon = getEquippedWeapon()) {
+        totalAttack += weapon->getEffect();
     }
     return totalAttack;
 }
 
-void Player::heal(int amount) {
+void Player::heal(int amount, std::ostream& out) {
     health = std::min(health + amount, maxHealth);
-    std::cout << "You heal for " << amount << " health. Current health: " << health << "/" << maxHealth << std::endl;
+    out << "You heal for " << amount << " health. Current health: " << health << "/" << maxHealth << '\n';
 }
 
-void Player::takeDamage(int damage) {
+void Player::takeDamage(int damage, std::ostream& out) {
     int actualDamage = std::max(1, damage - defense);
     health = std::max(0, health - actualDamage);
-    std::cout << "You take " << actualDamage << " damage. Current health: " << health << "/" << maxHealth << std::endl;
+    out << "You take " << actualDamage << " damage. Current health: " << health << "/" << maxHealth << '\n';
 }
 
-void Player::addItem(std::shared_ptr<Item> item) {
-    inventory.push_back(item);
-    std::cout << "You picked up: " << item->getName() << std::endl;
+ItemId Player::findItemId(std::string_view itemName) const {
+    auto it = data->itemIds.find(itemName);
+    return it != data->itemIds.end() ? it->second : NO_ITEM;
 }
 
-bool Player::hasItem(const std::string& itemName) const {
-    return std::any_of(inventory.begin(), inventory.end(),
-        [&itemName](const auto& item) {
-            return item->getName() == itemName;
-        });
+void Player::addItem(const Item& item, std::ostream& out) {
+    inventory.add(item.getId());
+    out << "You picked up: " << item.getName() << '\n';
 }
 
-std::shared_ptr<Item> Player::getItem(const std::string& itemName) {
-    auto it = std::find_if(inventory.begin(), inventory.end(),
-        [&itemName](const auto& item) {
-            return item->getName() == itemName;
-        });
-    
-    if (it != inventory.end()) {
-        return *it;
-    }
-    return nullptr;
+bool Player::hasItem(std::string_view itemName) const {
+    return inventory.contains(findItemId(itemName));
 }
 
-bool Player::removeItem(const std::string& itemName) {
-    auto it = std::find_if(inventory.begin(), inventory.end(),
-        [&itemName](const auto& item) {
-            return item->getName() == itemName;
-        });
-    
-    if (it != inventory.end()) {
-        inventory.erase(it);
-        return true;
-    }
-    return false;
+const Item* Player::getItem(std::string_view itemName) const {
+    ItemId id = findItemId(itemName);
+    return inventory.contains(id) ? &data->items[id] : nullptr;
 }
 
-void Player::showInventory() const {
-    std::cout << "\n=== INVENTORY ===" << std::endl;
-    std::cout << "Gold: " << gold << std::endl;
+bool Player::removeItem(std::string_view itemName) {
+    return inventory.remove(findItemId(itemName));
+}
+
+void Player::showInventory(std::ostream& out) const {
+    out << "\n=== INVENTORY ===\n";
+    out << "Gold: " << gold << '\n';
     
-    if (equippedWeapon) {
-        std::cout << "Equipped Weapon: " << equippedWeapon->getName() 
-                  << " (+" << equippedWeapon->getEffect() << " attack)" << std::endl;
+    if (const Item* weapon = getEquippedWeapon()) {
+        out << "Equipped Weapon: " << weapon->getName() 
+                  << " (+" << weapon->getEffect() << " attack)\n";
     }
     
     if (inventory.empty()) {
-        std::cout << "Your inventory is empty." << std::endl;
+        out << "Your inventory is empty.\n";
     } else {
-        std::cout << "Items:" << std::endl;
-        for (const auto& item : inventory) {
-            std::cout << "- " << item->getName() << " (" << item->getTypeString() << ")";
-            if (item->getEffect() > 0) {
-                std::cout << " [Effect: " << item->getEffect() << "]";
+        out << "Items:\n";
+        std::vector<Inventory::Stack> stacks;
+        inventory.stacksInPickupOrder(stacks);
+        for (const auto& stack : stacks) {
+            const Item& item = data->items[stack.item];
+            out << "- " << item.getName() << " (" << item.getTypeString() << ")";
+            if (item.getEffect() > 0) {
+                out << " [Effect: " << item.getEffect() << "]";
+            }
+            if (stack.count > 1) {
+                out << " x" << stack.count;
             }
-            std::cout << std::endl;
+            out << '\n';
         }
     }
-    std::cout << "=================" << std::endl;
+    out << "=================\n";
 }
 
-void Player::equipWeapon(std::shared_ptr<Item> weapon) {
-    if (weapon && weapon->getType() == Item::Type::WEAPON) {
-        equippedWeapon = weapon;
-        std::cout << "You equipped: " << weapon->getName() << " (+" << weapon->getEffect() << " attack)" << std::endl;
+void Player::equipWeapon(const Item& weapon, std::ostream& out) {
+    if (weapon.getType() == Item::Type::WEAPON) {
+        inventory.equip(EquipSlot::WEAPON, weapon.getId());
+        out << "You equipped: " << weapon.getName() << " (+" << weapon.getEffect() << " attack)\n";
     }
 }
 
-void Player::addMemory(const std::string& memory) {
-    if (!hasMemory(memory)) {
-        memoryJournal.push_back(memory);
-        std::cout << "\n*** MEMORY RECOVERED ***" << std::endl;
-        std::cout << memory << std::endl;
-        std::cout << "**********************" << std::endl;
-    }
+const Item* Player::getEquippedWeapon() const {
+    ItemId weapon = inventory.getEquipped(EquipSlot::WEAPON);
+    return weapon != NO_ITEM ? &data->items[weapon] : nullptr;
 }
 
-void Player::showMemoryJournal() const {
-    std::cout << "\n=== MEMORY JOURNAL ===" << std::endl;
+bool Player::addMemory(FlagId memory, std::ostream& out) {
+    if (!memories.set(memory)) return false;
+    
+    memoryJournal.push_back(memory);
+    out << "\n*** MEMORY RECOVERED ***\n";
+    out << data->memories[memory] << '\n';
+    out << "**********************\n";
+    return true;
+}
+
+void Player::showMemoryJournal(std::ostream& out) const {
+    out << "\n=== MEMORY JOURNAL ===\n";
     if (memoryJournal.empty()) {
-        std::cout << "No memories recovered yet..." << std::endl;
+        out << "No memories recovered yet...\n";
     } else {
         for (size_t i = 0; i < memoryJournal.size(); ++i) {
-            std::cout << (i + 1) << ". " << memoryJournal[i] << std::endl;
+            out << (i + 1) << ". " << data->memories[memoryJournal[i]] << '\n';
         }
     }
-    std::cout << "=====================" << std::endl;
-}
-
-bool Player::hasMemory(const std::string& memory) const {
-    return std::find(memoryJournal.begin(), memoryJournal.end(), memory) != memoryJournal.end();
+    out << "=====================\n";
 }
 
 bool Player::spendGold(int amount) {
@@ -126,33 +122,40 @@ bool Player::spendGold(int amount) {
     return false;
 }
 
-std::string Player::getSaveData() const {
-    std::ostringstream oss;
-    oss << name << "|" << health << "|" << maxHealth << "|" << attack << "|" << defense << "|" << gold;
+void Player::saveState(SnapshotWriter& writer) const {
+    writer.writeString(name);
+    writer.write<int32_t>(health);
+    writer.write<int32_t>(maxHealth);
+    writer.write<int32_t>(attack);
+    writer.write<int32_t>(defense);
+    writer.write<int32_t>(gold);
     
-    // Add inventory
-    oss << "|INV:";
-    for (const auto& item : inventory) {
-        oss << item->getName() << ",";
-    }
+    inventory.saveState(writer);
     
-    // Add equipped weapon
-    oss << "|WPN:";
-    if (equippedWeapon) {
-        oss << equippedWeapon->getName();
-    }
+    writer.writeArray(memoryJournal);
+}
+
+void Player::loadState(SnapshotReader& reader) {
+    name = reader.readString();
+    health = reader.read<int32_t>();
+    maxHealth = reader.read<int32_t>();
+    attack = reader.read<int32_t>();
+    defense = reader.read<int32_t>();
+    gold = reader.read<int32_t>();
     
-    // Add memories
-    oss << "|MEM:";
-    for (const auto& memory : memoryJournal) {
-        oss << memory << ";";
-    }
+    inventory.loadState(reader, data->items.size());
     
-    return oss.str();
+    reader.readArray(memoryJournal);
+    memories.clear();
+    for (FlagId memory : memoryJournal) {
+        if (memory >= data->memories.size()) SnapshotReader::fail("save refers to an unknown memory");
+        if (!memories.set(memory)) SnapshotReader::fail("save has a memory twice");
+    }
 }
 
-void Player::loadFromData(const std::string& data) {
-    // Implementation for loading would go here
-    // For now, this is a placeholder for the save/load system
-    std::cout << "Load functionality would restore player state from: " << data << std::endl;
+uint64_t Player::hashState() const {
+    uint64_t hash = hashMix(0, static_cast<uint64_t>(getAttack()));
+    hash = hashMix(hash, inventory.hashState());
+    hash = hashMix(hash, memories.hashState());
+    return hash;
 }
@@ -1,9 +1,17 @@
 #pragma once
 #include "Item.h"
+#include "Inventory.h"
+#include "FlagSet.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <map>
+#include <ostream>
+
+struct GameData;
+class SnapshotWriter;
+class SnapshotReader;
 
 class Player {
 private:
@@ -13,12 +21,16 @@ private:
     int attack;
     int defense;
     int gold;
-    std::vector<std::shared_ptr<Item>> inventory;
-    std::shared_ptr<Item> equippedWeapon;
-    std::vector<std::string> memoryJournal;
+    const GameData* data;   // the item definitions inventory ids refer to
+    Inventory inventory;
+    FlagSet memories;                      // by MemoryId
+    std::vector<FlagId> memoryJournal;     // the same memories, in the order recovered
+    
+    // Id of an item by name, or NO_ITEM if the game has no such item
+    ItemId findItemId(std::string_view itemName) const;
     
 public:
-    Player(const std::string& name);
+    Player(const std::string& name, const GameData& data);
     
     // Basic stats
     const std::string& getName() const { return name; }
@@ -29,31 +41,40 @@ public:
     int getGold() const { return gold; }
     
     // Health management
-    void heal(int amount);
-    void takeDamage(int damage);
+    void heal(int amount, std::ostream& out);
+    void takeDamage(int damage, std::ostream& out);
     bool isAlive() const { return health > 0; }
     
-    // Inventory management
-    void addItem(std::shared_ptr<Item> item);
-    bool hasItem(const std::string& itemName) const;
-    std::shared_ptr<Item> getItem(const std::string& itemName);
-    bool removeItem(const std::string& itemName);
-    void showInventory() const;
+    // Inventory management. Items are looked up by name in the game data
+    // and held as stacks of ids; getItem() returns the item's definition,
+    // or nullptr if the player has none.
+    void addItem(const Item& item, std::ostream& out);
+    bool hasItem(std::string_view itemName) const;
+    const Item* getItem(std::string_view itemName) const;
+    bool removeItem(std::string_view itemName);
+    void showInventory(std::ostream& out) const;
+    const Inventory& getInventory() const { return inventory; }
     
     // Equipment
-    void equipWeapon(std::shared_ptr<Item> weapon);
-    std::shared_ptr<Item> getEquippedWeapon() const { return equippedWeapon; }
+    void equipWeapon(const Item& weapon, std::ostream& out);
+    const Item* getEquippedWeapon() const;
     
-    // Memory journal system
-    void addMemory(const std::string& memory);
-    void showMemoryJournal() const;
-    bool hasMemory(const std::string& memory) const;
+    // Memory journal system. addMemory() returns true if the memory is new.
+    bool addMemory(FlagId memory, std::ostream& out);
+    void showMemoryJournal(std::ostream& out) const;
+    bool hasMemory(FlagId memory) const { return memories.test(memory); }
+    size_t getMemoryCount() const { return memoryJournal.size(); }
     
     // Gold management
     void addGold(int amount) { gold += amount; }
     bool spendGold(int amount);
     
-    // Save/Load helpers
-    std::string getSaveData() const;
-    void loadFromData(const std::string& data);
+    // Binary save games; items are stored as their ids
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader);
+    
+    // Hash of everything that can change how the game plays out, for
+    // search. Health is left out so searches can compare it instead, and
+    // gold and the order things were picked up in do not matter.
+    uint64_t hashState() const;
 };
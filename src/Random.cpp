@@ -0,0 +1,40 @@
+#include "Random.h"
+#include <random>
+
+Random::Random(uint64_t seed, uint64_t stream) : state(0), increment(0) {
+    this->seed(seed, stream);
+}
+
+void Random::seed(uint64_t seed, uint64_t stream) {
+    // Standard PCG32 seeding: the stream selects the (odd) increment
+    state = 0;
+    increment = (stream << 1u) | 1u;
+    next();
+    state += seed;
+    next();
+}
+
+int Random::range(int low, int high) {
+    // Lemire's multiply-shift with rejection keeps the result unbiased
+    uint32_t span = static_cast<uint32_t>(high - low) + 1u;
+    uint64_t product = static_cast<uint64_t>(next()) * span;
+    uint32_t fraction = static_cast<uint32_t>(product);
+    if (fraction < span) {
+        uint32_t threshold = (0u - span) % span;
+        while (fraction < threshold) {
+            product = static_cast<uint64_t>(next()) * span;
+            fraction = static_cast<uint32_t>(product);
+        }
+    }
+    return low + static_cast<int>(product >> 32);
+}
+
+void Random::restore(uint64_t state, uint64_t increment) {
+    this->state = state;
+    this->increment = increment | 1u;
+}
+
+uint64_t Random::randomSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) | device();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+// Small, fast PCG32 generator (O'Neill, pcg-random.org). Each session owns
+// one; the same seed and stream always replay the same sequence, and
+// different streams with the same seed are independent, so many sessions
+// can run on many threads without sharing state.
+class Random {
+private:
+    uint64_t state;
+    uint64_t increment;
+
+public:
+    explicit Random(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0);
+
+    void seed(uint64_t seed, uint64_t stream = 0);
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = static_cast<uint32_t>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+    }
+
+    // Uniform integer in [low, high]
+    int range(int low, int high);
+
+    // True with the given percent chance, the same as rolling 1-100 <= percent
+    bool chance(int percent) { return range(1, 100) <= percent; }
+
+    // Raw state, for save games and replays
+    uint64_t getState() const { return state; }
+    uint64_t getIncrement() const { return increment; }
+    void restore(uint64_t state, uint64_t increment);
+
+    // Non-deterministic seed for sessions that were not given one
+    static uint64_t randomSeed();
+};
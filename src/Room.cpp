@@ -1,86 +1,75 @@
 #include "Room.h"
-#include <iostream>
+#include "World.h"
+#include "FileManager.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+#include <ostream>
 #include <algorithm>
 
-Room::Room(const std::string& id, const std::string& name, const std::string& description)
-    : id(id), name(name), description(description), visited(false), hazard(HazardType::NONE) {}
+Room::Room(std::string_view id, std::string_view name, std::string_view description)
+    : id(id), index(NO_ROOM), name(name), description(description), hazard(HazardType::NONE), encounterChance(0) {}
 
-void Room::addExit(const std::string& direction, const std::string& roomId) {
-    exits[direction] = roomId;
-}
-
-std::string Room::getExit(const std::string& direction) const {
-    auto it = exits.find(direction);
-    if (it != exits.end()) {
-        return it->second;
-    }
-    return "";
-}
-
-std::vector<std::string> Room::getAvailableExits() const {
-    std::vector<std::string> directions;
-    for (const auto& exit : exits) {
-        directions.push_back(exit.first);
-    }
-    return directions;
-}
-
-void Room::addItem(std::shared_ptr<Item> item) {
+void Room::addItem(const Item* item) {
     items.push_back(item);
 }
 
-std::shared_ptr<Item> Room::takeItem(const std::string& itemName) {
+const Item* Room::takeItem(std::string_view itemName) {
     auto it = std::find_if(items.begin(), items.end(),
-        [&itemName](const auto& item) {
+        [&itemName](const Item* item) {
             return item->getName() == itemName;
         });
     
     if (it != items.end()) {
-        auto item = *it;
+        const Item* item = *it;
         items.erase(it);
         return item;
     }
     return nullptr;
 }
 
-bool Room::hasItem(const std::string& itemName) const {
+bool Room::hasItem(std::string_view itemName) const {
     return std::any_of(items.begin(), items.end(),
-        [&itemName](const auto& item) {
+        [&itemName](const Item* item) {
             return item->getName() == itemName;
         });
 }
 
-void Room::listItems() const {
+void Room::listItems(std::ostream& out) const {
     if (!items.empty()) {
-        std::cout << "Items here:" << std::endl;
-        for (const auto& item : items) {
-            std::cout << "- " << item->getName() << " (" << item->getDescription() << ")" << std::endl;
+        out << "Items here:\n";
+        for (const Item* item : items) {
+            out << "- " << item->getName() << " (" << item->getDescription() << ")\n";
         }
     }
 }
 
-void Room::addEnemy(std::shared_ptr<Enemy> enemy) {
-    enemies.push_back(enemy);
-}
-
-std::shared_ptr<Enemy> Room::getAliveEnemy() const {
-    for (const auto& enemy : enemies) {
-        if (enemy->alive()) {
-            return enemy;
-        }
+void Room::saveState(SnapshotWriter& writer) const {
+    writer.writeString(specialEvent);
+    writer.write(static_cast<uint32_t>(items.size()));
+    for (const Item* item : items) {
+        writer.write(item->getId());
     }
-    return nullptr;
 }
 
-bool Room::hasAliveEnemies() const {
-    return getAliveEnemy() != nullptr;
+void Room::loadState(SnapshotReader& reader, const GameData& data) {
+    specialEvent = reader.readString();
+    
+    items.clear();
+    uint32_t itemCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < itemCount; ++i) {
+        uint32_t id = reader.read<uint32_t>();
+        if (id >= data.items.size()) SnapshotReader::fail("save refers to an unknown item");
+        items.push_back(&data.items[id]);
+    }
 }
 
-void Room::removeDeadEnemies() {
-    enemies.erase(
-        std::remove_if(enemies.begin(), enemies.end(),
-            [](const auto& enemy) { return !enemy->alive(); }),
-        enemies.end());
+uint64_t Room::hashState() const {
+    // Summed so the order items were dropped in does not matter
+    uint64_t itemSum = 0;
+    for (const Item* item : items) {
+        itemSum += hashText(item->getName());
+    }
+    return hashMix(items.size(), itemSum);
 }
 
 std::string Room::getHazardDescription() const {
@@ -98,42 +87,47 @@ std::string Room::getHazardDescription() const {
     }
 }
 
-void Room::displayRoom() const {
-    std::cout << "\n=== " << name << " ===" << std::endl;
-    std::cout << description << std::endl;
+void Room::displayRoom(std::ostream& out, const World& world) const {
+    out << "\n=== " << name << " ===\n";
+    out << description << '\n';
     
     if (hazard != HazardType::NONE) {
-        std::cout << "\n" << getHazardDescription() << std::endl;
+        out << "\n" << getHazardDescription() << '\n';
     }
     
-    listItems();
+    listItems(out);
     
-    if (hasAliveEnemies()) {
-        std::cout << "\nEnemies present:" << std::endl;
-        for (const auto& enemy : enemies) {
-            if (enemy->alive()) {
-                std::cout << "- " << enemy->getName() << " (" << enemy->getTypeString() << ")" << std::endl;
-            }
+    const EnemyStore& enemies = world.getEnemies();
+    if (enemies.hasEnemies(index)) {
+        out << "\nEnemies present:\n";
+        for (EnemyId enemy = enemies.firstInRoom(index); enemy != NO_ENEMY; enemy = enemies.nextEnemy(enemy)) {
+            out << "- " << enemies.getName(enemy) << " (" << enemies.getTemplate(enemy).getTypeString() << ")\n";
         }
     }
     
-    std::cout << "\nExits: ";
-    auto exitList = getAvailableExits();
-    if (exitList.empty()) {
-        std::cout << "None";
-    } else {
-        for (size_t i = 0; i < exitList.size(); ++i) {
-            std::cout << exitList[i];
-            if (i < exitList.size() - 1) std::cout << ", ";
+    // Listed alphabetically, as players have always seen them
+    static const Direction displayOrder[] = {Direction::EAST, Direction::NORTH, Direction::SOUTH, Direction::WEST};
+    
+    const ExitRow& exits = world.getExits(index);
+    out << "\nExits: ";
+    bool anyExit = false;
+    for (Direction direction : displayOrder) {
+        if (exits[static_cast<size_t>(direction)] != NO_ROOM) {
+            if (anyExit) out << ", ";
+            out << directionName(direction);
+            anyExit = true;
         }
     }
-    std::cout << std::endl;
+    if (!anyExit) {
+        out << "None";
+    }
+    out << '\n';
     
     if (!specialEvent.empty()) {
-        std::cout << "\n" << specialEvent << std::endl;
+        out << "\n" << specialEvent << '\n';
     }
 }
 
-void Room::lookAround() const {
-    displayRoom();
+void Room::lookAround(std::ostream& out, const World& world) const {
+    displayRoom(out, world);
 }
@@ -1,11 +1,21 @@
 #pragma once
 #include "Item.h"
-#include "Enemy.h"
+#include "Direction.h"
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 #include <map>
+#include <ostream>
 
+class World;
+struct GameData;
+class SnapshotWriter;
+class SnapshotReader;
+
+// A room the player can be in. Its id, name and description view the game
+// data, and its items point into the game data's item list, so building a
+// room copies no text; the world keeps the game data alive for as long as
+// any of its rooms.
 class Room {
 public:
     enum class HazardType {
@@ -17,53 +27,51 @@ public:
     };
 
 private:
-    std::string id;
-    std::string name;
-    std::string description;
-    std::map<std::string, std::string> exits;
-    std::vector<std::shared_ptr<Item>> items;
-    std::vector<std::shared_ptr<Enemy>> enemies;
-    bool visited;
+    std::string_view id;
+    RoomId index;
+    std::string_view name;
+    std::string_view description;
+    std::vector<const Item*> items;
     HazardType hazard;
     std::string specialEvent;
+    int encounterChance;
     
 public:
-    Room(const std::string& id, const std::string& name, const std::string& description);
+    Room(std::string_view id, std::string_view name, std::string_view description);
     
     // Basic info
-    const std::string& getId() const { return id; }
-    const std::string& getName() const { return name; }
-    const std::string& getDescription() const { return description; }
-    bool isVisited() const { return visited; }
-    void setVisited(bool v) { visited = v; }
-    
-    // Navigation
-    void addExit(const std::string& direction, const std::string& roomId);
-    std::string getExit(const std::string& direction) const;
-    std::vector<std::string> getAvailableExits() const;
-    
-    // Items
-    void addItem(std::shared_ptr<Item> item);
-    std::shared_ptr<Item> takeItem(const std::string& itemName);
-    bool hasItem(const std::string& itemName) const;
-    void listItems() const;
+    std::string_view getId() const { return id; }
+    RoomId getIndex() const { return index; }
+    void setIndex(RoomId i) { index = i; }
+    std::string_view getName() const { return name; }
+    std::string_view getDescription() const { return description; }
     
-    // Enemies
-    void addEnemy(std::shared_ptr<Enemy> enemy);
-    std::shared_ptr<Enemy> getAliveEnemy() const;
-    bool hasAliveEnemies() const;
-    void removeDeadEnemies();
+    // Items, by pointer into the game data's item list
+    void addItem(const Item* item);
+    const Item* takeItem(std::string_view itemName);
+    bool hasItem(std::string_view itemName) const;
+    void listItems(std::ostream& out) const;
+    const std::vector<const Item*>& getItems() const { return items; }
     
     // Environmental effects
     void setHazard(HazardType hazard) { this->hazard = hazard; }
     HazardType getHazard() const { return hazard; }
     std::string getHazardDescription() const;
     
+    // Random encounters: percent chance an enemy appears on arrival
+    void setEncounterChance(int chance) { encounterChance = chance; }
+    int getEncounterChance() const { return encounterChance; }
+    
     // Special events
     void setSpecialEvent(const std::string& event) { specialEvent = event; }
     const std::string& getSpecialEvent() const { return specialEvent; }
     
-    // Display
-    void displayRoom() const;
-    void lookAround() const;
+    // Save games: only what play can change (event text, items)
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader, const GameData& data);
+    uint64_t hashState() const;
+    
+    // Display (exits and enemies live in the World, keyed by this room's index)
+    void displayRoom(std::ostream& out, const World& world) const;
+    void lookAround(std::ostream& out, const World& world) const;
 };
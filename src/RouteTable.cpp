@@ -0,0 +1,129 @@
+#include "RouteTable.h"
+#include <algorithm>
+
+template <typename Visit>
+void RouteTable::forEachIncoming(const ExitTable& exits, RoomId to, Visit visit) const {
+    auto visitExits = [&](RoomId from) {
+        for (size_t direction = 0; direction < DIRECTION_COUNT; ++direction) {
+            if (exits[from][direction] == to) {
+                visit(from, static_cast<Direction>(direction));
+            }
+        }
+    };
+
+    for (uint32_t i = incomingStart[to]; i < incomingStart[to + 1]; ++i) {
+        visitExits(incoming[i]);
+    }
+    if (!addedIncoming.empty()) {
+        auto added = addedIncoming.equal_range(to);
+        for (auto it = added.first; it != added.second; ++it) {
+            visitExits(it->second);
+        }
+    }
+}
+
+void RouteTable::clear() {
+    trees.clear();
+    incomingStart.clear();
+    incoming.clear();
+    addedIncoming.clear();
+}
+
+void RouteTable::buildIncoming(const ExitTable& exits) {
+    // Counting sort of every exit by the room it leads to. Exits out of
+    // range (only a damaged world image has them) are left out.
+    const size_t count = exits.size();
+    incomingStart.assign(count + 1, 0);
+    for (RoomId from = 0; from < count; ++from) {
+        for (RoomId to : exits[from]) {
+            if (to < count) incomingStart[to + 1]++;
+        }
+    }
+    for (size_t id = 0; id < count; ++id) {
+        incomingStart[id + 1] += incomingStart[id];
+    }
+
+    incoming.resize(incomingStart.back());
+    std::vector<uint32_t> fill(incomingStart.begin(), incomingStart.end() - 1);
+    for (RoomId from = 0; from < count; ++from) {
+        for (RoomId to : exits[from]) {
+            // A room with two exits into the same room is listed once
+            if (to < count && (fill[to] == incomingStart[to] || incoming[fill[to] - 1] != from)) {
+                incoming[fill[to]++] = from;
+            }
+        }
+    }
+    addedIncoming.clear();
+}
+
+RouteTable::Tree& RouteTable::treeFor(const ExitTable& exits, RoomId target) {
+    // Built on the first query; a world's size never changes
+    if (incomingStart.size() != exits.size() + 1) {
+        clear();
+        buildIncoming(exits);
+    }
+
+    useCount++;
+    for (auto& tree : trees) {
+        if (tree.target == target) {
+            tree.lastUsed = useCount;
+            return tree;
+        }
+    }
+
+    if (trees.size() == MAX_TREES) {
+        auto oldest = std::min_element(trees.begin(), trees.end(),
+            [](const Tree& a, const Tree& b) { return a.lastUsed < b.lastUsed; });
+        trees.erase(oldest);
+    }
+    trees.push_back(Tree{target, useCount, {}, {}});
+    Tree& tree = trees.back();
+    tree.distance.assign(exits.size(), UNREACHABLE);
+    tree.nextStep.assign(exits.size(), Direction::NONE);
+    tree.distance[target] = 0;
+    propagate(exits, tree, target);
+    return tree;
+}
+
+void RouteTable::propagate(const ExitTable& exits, Tree& tree, RoomId start) {
+    // Plain breadth-first search backwards from start; rooms already at
+    // least as close are left alone, so this also serves for updates
+    std::vector<RoomId> queue{start};
+    for (size_t head = 0; head < queue.size(); ++head) {
+        RoomId room = queue[head];
+        uint32_t distance = tree.distance[room] + 1;
+        forEachIncoming(exits, room, [&](RoomId from, Direction direction) {
+            if (distance < tree.distance[from]) {
+                tree.distance[from] = distance;
+                tree.nextStep[from] = direction;
+                queue.push_back(from);
+            }
+        });
+    }
+}
+
+Direction RouteTable::nextStep(const ExitTable& exits, RoomId from, RoomId to) {
+    return treeFor(exits, to).nextStep[from];
+}
+
+void RouteTable::exitChanged(const ExitTable& exits, RoomId from, Direction direction,
+                             RoomId oldTo, RoomId newTo) {
+    if (incomingStart.empty()) return;
+
+    if (oldTo != NO_ROOM) {
+        // Only routes that went through the old exit get longer
+        trees.erase(std::remove_if(trees.begin(), trees.end(),
+            [&](const Tree& tree) { return tree.nextStep[from] == direction; }), trees.end());
+    }
+
+    if (newTo != NO_ROOM) {
+        addedIncoming.emplace(newTo, from);
+        for (auto& tree : trees) {
+            if (tree.distance[newTo] != UNREACHABLE && tree.distance[newTo] + 1 < tree.distance[from]) {
+                tree.distance[from] = tree.distance[newTo] + 1;
+                tree.nextStep[from] = direction;
+                propagate(exits, tree, from);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "ExitTable.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Shortest routes over a world's exits, for the travel command. For each
+// destination asked about, one breadth-first search over the reversed
+// exits records which way to go from every room, so following a route
+// costs one lookup per step. A few recent destinations are kept.
+//
+// Exit changes are applied incrementally: a new exit only shortens the
+// routes that now run through it, and a removed one only drops the
+// destinations whose routes used it.
+class RouteTable {
+private:
+    static constexpr size_t MAX_TREES = 8;
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    // Every room's route to one destination
+    struct Tree {
+        RoomId target;
+        uint64_t lastUsed;
+        std::vector<uint32_t> distance;   // steps to target, by RoomId
+        std::vector<Direction> nextStep;  // which exit to take, by RoomId
+    };
+
+    std::vector<Tree> trees;
+    uint64_t useCount;
+
+    // Rooms with an exit into each room, as built from the exit table
+    // (incomingStart has one entry per room plus one), plus exits added
+    // since. Entries can go stale, so exits are re-checked when followed.
+    std::vector<uint32_t> incomingStart;
+    std::vector<RoomId> incoming;
+    std::unordered_multimap<RoomId, RoomId> addedIncoming;
+
+    void buildIncoming(const ExitTable& exits);
+    Tree& treeFor(const ExitTable& exits, RoomId target);
+
+    // Lowers distances behind a room whose own distance just dropped
+    void propagate(const ExitTable& exits, Tree& tree, RoomId start);
+
+    // Calls visit(from, direction) for every exit leading into a room
+    template <typename Visit>
+    void forEachIncoming(const ExitTable& exits, RoomId to, Visit visit) const;
+
+public:
+    RouteTable() : useCount(0) {}
+
+    bool empty() const { return trees.empty() && incoming.empty(); }
+    void clear();
+
+    // The exit to take from one room to get closer to another, or
+    // Direction::NONE when there is no way there (or from == to)
+    Direction nextStep(const ExitTable& exits, RoomId from, RoomId to);
+
+    // Called after exits[from][direction] changed from oldTo to newTo
+    void exitChanged(const ExitTable& exits, RoomId from, Direction direction,
+                     RoomId oldTo, RoomId newTo);
+};
@@ -0,0 +1,186 @@
+#include "SelfCheck.h"
+#include "ExitTable.h"
+#include "RouteTable.h"
+#include "Random.h"
+#include "GameEngine.h"
+#include "GameIO.h"
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+namespace {
+
+// Steps taken following a table's routes from one room to another, or
+// NO_ROUTE if they lead nowhere. Every step must be a real exit, and a
+// route longer than the world is going round in circles.
+const size_t NO_ROUTE = SIZE_MAX;
+
+size_t walk(RouteTable& routes, const ExitTable& exits, RoomId from, RoomId to) {
+    size_t steps = 0;
+    while (from != to) {
+        Direction direction = routes.nextStep(exits, from, to);
+        if (direction == Direction::NONE) return NO_ROUTE;
+        from = exits[from][static_cast<size_t>(direction)];
+        if (from >= exits.size() || ++steps > exits.size()) return NO_ROUTE - 1;
+    }
+    return steps;
+}
+
+const char* stateName(GameEngine::InputState state) {
+    switch (state) {
+        case GameEngine::InputState::NAME: return "name";
+        case GameEngine::InputState::COMMAND: return "command";
+        case GameEngine::InputState::COMBAT_CHOICE: return "combat choice";
+        case GameEngine::InputState::COMBAT_ITEM: return "combat item";
+        case GameEngine::InputState::QUIT_CONFIRM: return "quit confirmation";
+        case GameEngine::InputState::FINISHED: return "finished";
+    }
+    return "unknown";
+}
+
+// Plays line on both sessions and compares what they print
+bool sameTurn(GameEngine& expected, StringSink& expectedOut, GameEngine& actual, StringSink& actualOut,
+              const std::string& line) {
+    expected.flushOutput();
+    actual.flushOutput();
+    expectedOut.clear();
+    actualOut.clear();
+    expected.handleLine(line);
+    actual.handleLine(line);
+    expected.flushOutput();
+    actual.flushOutput();
+    return expectedOut.str() == actualOut.str();
+}
+
+} // namespace
+
+bool SelfCheck::routes(uint64_t seed, std::ostream& out) {
+    const RoomId ROOMS = 60;
+    const int CHANGES = 3000;
+    Random rng(seed);
+
+    // A sparse random graph, so exits added and removed keep cutting and
+    // joining routes
+    auto randomTarget = [&]() { return rng.chance(40) ? RoomId(rng.range(0, ROOMS - 1)) : NO_ROOM; };
+    std::vector<ExitRow> rows(ROOMS);
+    for (ExitRow& row : rows) {
+        for (RoomId& to : row) to = randomTarget();
+    }
+    ExitTable exits(rows.data(), ROOMS);
+    RouteTable incremental;
+
+    for (int change = 0; change < CHANGES; ++change) {
+        // Ask about a few destinations first, so the table holds trees for
+        // the change to update, and now and then more than it keeps
+        for (int query = 0; query < 3; ++query) {
+            incremental.nextStep(exits, RoomId(rng.range(0, ROOMS - 1)), RoomId(rng.range(0, ROOMS - 1)));
+        }
+
+        RoomId from = RoomId(rng.range(0, ROOMS - 1));
+        Direction direction = static_cast<Direction>(rng.range(0, DIRECTION_COUNT - 1));
+        RoomId oldTo = exits[from][static_cast<size_t>(direction)];
+        RoomId newTo = randomTarget();
+        if (newTo == oldTo) continue;
+        exits.set(from, direction, newTo);
+        incremental.exitChanged(exits, from, direction, oldTo, newTo);
+
+        // Shortest routes can tie, so the two tables may take different
+        // exits; what must agree is whether there is a route and how long
+        RouteTable fresh;
+        RoomId to = RoomId(rng.range(0, ROOMS - 1));
+        for (RoomId start = 0; start < ROOMS; ++start) {
+            size_t expected = walk(fresh, exits, start, to);
+            size_t actual = walk(incremental, exits, start, to);
+            if (actual != expected) {
+                auto describe = [](size_t steps) {
+                    return steps == NO_ROUTE ? std::string("no route")
+                         : steps == NO_ROUTE - 1 ? std::string("a broken route")
+                         : std::to_string(steps) + " steps";
+                };
+                out << "routes: after change " << change << " to room " << from << "'s " << directionName(direction)
+                    << " exit, the route from " << start << " to " << to << " is " << describe(actual)
+                    << " instead of " << describe(expected) << '\n';
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool SelfCheck::saves(std::shared_ptr<const GameData> data, uint64_t seed, std::ostream& out) {
+    const int SESSIONS = 20;
+    const int LINES = 200;
+    Random rng(seed);
+    std::vector<std::string> commands;
+    std::string snapshot;
+    std::string previous;
+    std::string bad;
+    bool reached[static_cast<size_t>(GameEngine::InputState::FINISHED)] = {};
+
+    for (int session = 0; session < SESSIONS; ++session) {
+        StringSink playedOut;
+        GameEngine played(playedOut, data, seed + session);
+        played.beginSession();
+        played.handleLine("Tester");
+        previous.clear();
+
+        for (int line = 0; line < LINES && !played.isFinished(); ++line) {
+            // Random play, with the odd quit taken back and item asked for
+            // mid-fight, potion or not, so those prompts get saved too
+            GameEngine::InputState state = played.getInputState();
+            reached[static_cast<size_t>(state)] = true;
+            played.legalCommands(commands);
+            std::string next = state == GameEngine::InputState::QUIT_CONFIRM ? "n"
+                             : state == GameEngine::InputState::COMMAND && rng.chance(5) ? "quit"
+                             : state == GameEngine::InputState::COMBAT_CHOICE && rng.chance(10) ? "use"
+                             : commands.empty() ? "look"
+                             : commands[rng.range(0, int(commands.size()) - 1)];
+            auto fail = [&](const std::string& what) {
+                out << "saves: session " << session << ", line " << line << " at the "
+                    << stateName(state) << " prompt: " << what << '\n';
+                return false;
+            };
+
+            // A different seed, so only the save can make the sessions agree
+            played.saveState(snapshot);
+            StringSink loadedOut;
+            GameEngine loaded(loadedOut, data, ~seed);
+            loaded.loadState(snapshot);
+            if (loaded.getInputState() != state || loaded.stateHash() != played.stateHash()) {
+                return fail("the loaded session differs from the saved one");
+            }
+
+            // A bad save must fail to load and leave the session as it was.
+            // It is cut from the previous prompt's save, so anything it
+            // leaks into the session shows.
+            bad = previous.empty() ? snapshot : previous;
+            if (rng.chance(50)) {
+                bad.resize(rng.range(0, int(bad.size()) - 1));
+            } else {
+                ++bad[sizeof(uint32_t)];
+            }
+            previous = snapshot;
+            try {
+                loaded.loadState(bad);
+                return fail("a truncated or wrong version save loaded");
+            } catch (const std::runtime_error&) {
+            }
+            if (loaded.getInputState() != state || loaded.stateHash() != played.stateHash()) {
+                return fail("a save that failed to load changed the session");
+            }
+
+            if (!sameTurn(played, playedOut, loaded, loadedOut, next)) {
+                return fail("'" + next + "' plays differently after loading");
+            }
+        }
+    }
+
+    // Some content gives random play no fight to pick; say what went unchecked
+    for (auto state : {GameEngine::InputState::COMMAND, GameEngine::InputState::COMBAT_CHOICE,
+                       GameEngine::InputState::COMBAT_ITEM, GameEngine::InputState::QUIT_CONFIRM}) {
+        if (!reached[static_cast<size_t>(state)]) {
+            out << "saves: random play never reached the " << stateName(state) << " prompt, so it went unchecked\n";
+        }
+    }
+    return true;
+}
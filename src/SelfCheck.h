@@ -0,0 +1,19 @@
+#pragma once
+#include "FileManager.h"
+#include <memory>
+#include <ostream>
+#include <cstdint>
+
+// Checks run by --selfcheck. Each pits a part of the game that takes a
+// shortcut against the slow, obviously right way of getting the same
+// answer, over many seeded random cases, and reports the first case where
+// they disagree.
+class SelfCheck {
+public:
+    // Incremental route updates against routes built from scratch
+    static bool routes(uint64_t seed, std::ostream& out);
+    // Sessions saved at every prompt of random play against the sessions
+    // loaded from the saves, and bad saves against the sessions they fail
+    // to load into
+    static bool saves(std::shared_ptr<const GameData> data, uint64_t seed, std::ostream& out);
+};
@@ -0,0 +1,13 @@
+#include "Snapshot.h"
+#include <stdexcept>
+
+const char* SnapshotReader::take(size_t bytes) {
+    if (bytes > data.size() - pos) fail("save data is truncated");
+    const char* start = data.data() + pos;
+    pos += bytes;
+    return start;
+}
+
+void SnapshotReader::fail(const std::string& message) {
+    throw std::runtime_error(message);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Binary save format helpers. Values are stored as raw host-order bytes,
+// strings and arrays as a 32-bit count followed by their contents, so a
+// snapshot is a handful of memcpys into one reusable buffer.
+class SnapshotWriter {
+private:
+    std::string& buffer;
+
+public:
+    // Appends to buffer; callers clear and reuse it between snapshots
+    explicit SnapshotWriter(std::string& buffer) : buffer(buffer) {}
+
+    template <typename T>
+    void write(T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "write() takes plain values");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(std::string_view text) {
+        write(static_cast<uint32_t>(text.size()));
+        buffer.append(text.data(), text.size());
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "writeArray() takes plain values");
+        write(static_cast<uint32_t>(values.size()));
+        buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+};
+
+// Reads what SnapshotWriter wrote; throws std::runtime_error on truncated
+// or malformed data
+class SnapshotReader {
+private:
+    std::string_view data;
+    size_t pos;
+
+    const char* take(size_t bytes);
+
+public:
+    explicit SnapshotReader(std::string_view data) : data(data), pos(0) {}
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "read() returns plain values");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string_view readString() {
+        uint32_t size = read<uint32_t>();
+        return std::string_view(take(size), size);
+    }
+
+    template <typename T>
+    void readArray(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "readArray() fills plain values");
+        uint32_t count = read<uint32_t>();
+        if (count > (data.size() - pos) / sizeof(T)) fail("array runs past the end of the save");
+        values.resize(count);
+        std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+    }
+
+    bool atEnd() const { return pos == data.size(); }
+
+    [[noreturn]] static void fail(const std::string& message);
+};
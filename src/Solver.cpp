@@ -0,0 +1,177 @@
+#include "Solver.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// Best player health reached in every state seen so far, split into
+// independently locked shards so workers rarely wait on each other
+class TranspositionTable {
+private:
+    static const size_t SHARDS = 64;
+
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<uint64_t, int> bestHealth;
+    };
+    Shard shards[SHARDS];
+    std::atomic<size_t> count;
+
+public:
+    TranspositionTable() : count(0) {}
+
+    // True if the state is new, or reached with more health than before:
+    // anything the weaker copy can do, the stronger one can too
+    bool insert(uint64_t hash, int health) {
+        // The low bits pick the bucket inside a shard, so shard on the high ones
+        Shard& shard = shards[hash >> 58];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto inserted = shard.bestHealth.emplace(hash, health);
+        if (inserted.second) {
+            count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (health <= inserted.first->second) return false;
+        inserted.first->second = health;
+        return true;
+    }
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+};
+
+// One session on the current frontier and how it was reached
+struct Node {
+    std::unique_ptr<GameEngine> game;
+    uint32_t link;      // index into the search's links
+};
+
+// One edge of the search tree, kept for every level to rebuild the path
+struct Link {
+    uint32_t parent;
+    std::string command;
+};
+
+const uint32_t NO_LINK = UINT32_MAX;
+
+// What one worker produced from its share of a level
+struct Expansion {
+    struct Child {
+        std::unique_ptr<GameEngine> game;
+        uint64_t order;     // frontier index << 32 | command index, for a stable merge
+        uint32_t parent;
+        std::string command;
+    };
+    std::vector<Child> children;
+    uint64_t winOrder = UINT64_MAX;
+    size_t explored = 0;
+};
+
+} // namespace
+
+Solver::Solver(std::shared_ptr<const GameData> data, uint64_t seed, unsigned threads)
+    : data(std::move(data)), seed(seed), threadCount(threads) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+Solver::Result Solver::solve(size_t maxDepth, size_t maxStates) {
+    Result result{false, {}, 0, 0};
+
+    // Silent sessions never write, but every engine needs a sink to hold
+    NullSink sink;
+    auto root = std::make_unique<GameEngine>(sink, data, seed);
+    root->beginSession();
+    root->step(playerName());
+
+    TranspositionTable table;
+    table.insert(root->stateHash(), root->getPlayerHealth());
+
+    std::vector<Link> links;
+    links.push_back({NO_LINK, playerName()});
+    std::vector<Node> frontier;
+    frontier.push_back({std::move(root), 0});
+
+    std::vector<Expansion> expansions(threadCount);
+    while (!frontier.empty() && result.depth < maxDepth && table.size() < maxStates) {
+        result.depth++;
+        std::atomic<size_t> next(0);
+
+        auto expand = [&](Expansion& expansion) {
+            std::vector<std::string> commands;
+            size_t index;
+            while ((index = next.fetch_add(1, std::memory_order_relaxed)) < frontier.size()) {
+                const GameEngine& parent = *frontier[index].game;
+                parent.legalCommands(commands);
+
+                for (size_t c = 0; c < commands.size(); ++c) {
+                    uint64_t order = (uint64_t(index) << 32) | c;
+                    auto child = parent.fork(sink);
+                    child->step(commands[c]);
+                    expansion.explored++;
+
+                    if (child->hasWon()) {
+                        expansion.winOrder = std::min(expansion.winOrder, order);
+                        continue;
+                    }
+                    if (child->isFinished() || !table.insert(child->stateHash(), child->getPlayerHealth())) {
+                        continue;
+                    }
+                    expansion.children.push_back({std::move(child), order, frontier[index].link, commands[c]});
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threadCount; ++t) {
+            workers.emplace_back(expand, std::ref(expansions[t]));
+        }
+        expand(expansions[0]);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // The first win in frontier order, whichever worker found it
+        uint64_t winOrder = UINT64_MAX;
+        for (auto& expansion : expansions) {
+            winOrder = std::min(winOrder, expansion.winOrder);
+            result.statesExplored += expansion.explored;
+            expansion.explored = 0;
+            expansion.winOrder = UINT64_MAX;
+        }
+
+        if (winOrder != UINT64_MAX) {
+            const Node& winner = frontier[winOrder >> 32];
+            std::vector<std::string> commands;
+            winner.game->legalCommands(commands);
+            result.commands.push_back(commands[winOrder & 0xffffffffu]);
+            for (uint32_t link = winner.link; link != NO_LINK; link = links[link].parent) {
+                result.commands.push_back(links[link].command);
+            }
+            std::reverse(result.commands.begin(), result.commands.end());
+            result.solved = true;
+            break;
+        }
+
+        // Merge in frontier order so the next level does not depend on scheduling
+        std::vector<Expansion::Child> children;
+        for (auto& expansion : expansions) {
+            std::move(expansion.children.begin(), expansion.children.end(), std::back_inserter(children));
+            expansion.children.clear();
+        }
+        std::sort(children.begin(), children.end(),
+            [](const auto& a, const auto& b) { return a.order < b.order; });
+
+        frontier.clear();
+        frontier.reserve(children.size());
+        for (auto& child : children) {
+            links.push_back({child.parent, std::move(child.command)});
+            frontier.push_back({std::move(child.game), static_cast<uint32_t>(links.size() - 1)});
+        }
+    }
+
+    return result;
+}
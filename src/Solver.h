@@ -0,0 +1,43 @@
+#pragma once
+#include "GameEngine.h"
+#include "FileManager.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Finds the shortest command sequence that wins a session with a given
+// seed. Breadth-first search over forked sessions, one level at a time,
+// with each level expanded in parallel. States that hash alike (see
+// GameEngine::stateHash) are explored once, via a shared transposition
+// table, unless reached again with more health. Since every session
+// replays exactly from its seed, the solution is a script that wins when
+// played back with that seed.
+//
+// Also useful for checking content packs: an unsolvable world, or one
+// whose shortest win is suspiciously long, shows up here.
+class Solver {
+public:
+    struct Result {
+        bool solved;
+        std::vector<std::string> commands;  // starting with the player name
+        size_t statesExplored;
+        size_t depth;                       // levels searched
+    };
+
+private:
+    std::shared_ptr<const GameData> data;
+    uint64_t seed;
+    unsigned threadCount;
+
+public:
+    // threads = 0 uses every hardware thread
+    Solver(std::shared_ptr<const GameData> data, uint64_t seed, unsigned threads = 0);
+
+    // Gives up after maxDepth commands or once maxStates distinct states
+    // have been seen
+    Result solve(size_t maxDepth = 200, size_t maxStates = 1000000);
+
+    static const char* playerName() { return "Hero"; }
+};
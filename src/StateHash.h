@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// 64-bit hashing of game state for search (see Solver). Not stable across
+// builds or versions; only compared within one run.
+inline uint64_t hashMix(uint64_t hash, uint64_t value) {
+    // splitmix64 finalizer on the value, then fold it in
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return (hash ^ value) * 0x100000001b3ULL + (hash >> 29);
+}
+
+inline uint64_t hashText(std::string_view text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,120 @@
+#include "TimingWheel.h"
+#include "Snapshot.h"
+#include <algorithm>
+
+void TimingWheel::file(uint32_t entry) {
+    // The level is the highest 6-bit digit in which due and the clock
+    // differ, so an event cascades down one level each time the clock
+    // reaches that digit
+    uint32_t due = entries[entry].due;
+    uint32_t differ = due ^ clock;
+    unsigned level = 0;
+    while (level < LEVELS && (differ >> (SLOT_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    uint32_t slot = level == LEVELS ? OVERFLOW_SLOT : level * SLOTS + ((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+    entries[entry].next = heads[slot];
+    heads[slot] = entry;
+}
+
+uint32_t TimingWheel::takeSlot(uint32_t slot) {
+    uint32_t first = heads[slot];
+    heads[slot] = NO_ENTRY;
+    return first;
+}
+
+void TimingWheel::schedule(uint32_t due, TimedEvent event) {
+    if (heads.empty()) {
+        heads.assign(OVERFLOW_SLOT + 1, NO_ENTRY);
+    }
+    uint32_t entry = freeEntries;
+    if (entry != NO_ENTRY) {
+        freeEntries = entries[entry].next;
+    } else {
+        entry = static_cast<uint32_t>(entries.size());
+        entries.push_back({});
+    }
+    entries[entry].due = std::max(due, clock + 1);
+    entries[entry].event = event;
+    file(entry);
+    count++;
+}
+
+void TimingWheel::cascade() {
+    // Called when the clock's lowest digit wraps to 0: refile the slot each
+    // higher level has just reached, stopping at the first level that did
+    // not wrap itself
+    unsigned level = 1;
+    for (; level < LEVELS; ++level) {
+        uint32_t digit = (clock >> (SLOT_BITS * level)) & (SLOTS - 1);
+        for (uint32_t entry = takeSlot(level * SLOTS + digit); entry != NO_ENTRY;) {
+            uint32_t next = entries[entry].next;
+            file(entry);
+            entry = next;
+        }
+        if (digit != 0) return;
+    }
+    for (uint32_t entry = takeSlot(OVERFLOW_SLOT); entry != NO_ENTRY;) {
+        uint32_t next = entries[entry].next;
+        file(entry);
+        entry = next;
+    }
+}
+
+void TimingWheel::advanceTo(uint32_t turn, std::vector<TimedEvent>& due) {
+    while (clock < turn) {
+        if (count == 0) {
+            clock = turn;
+            return;
+        }
+        clock++;
+        if ((clock & (SLOTS - 1)) == 0) {
+            cascade();
+        }
+        for (uint32_t entry = takeSlot(clock & (SLOTS - 1)); entry != NO_ENTRY;) {
+            uint32_t next = entries[entry].next;
+            due.push_back(entries[entry].event);
+            entries[entry].next = freeEntries;
+            freeEntries = entry;
+            count--;
+            entry = next;
+        }
+    }
+}
+
+void TimingWheel::saveState(SnapshotWriter& writer) const {
+    // Triples of (due, kind, payload)
+    std::vector<uint32_t> waiting;
+    waiting.reserve(count * 3);
+    for (uint32_t head : heads) {
+        for (uint32_t entry = head; entry != NO_ENTRY; entry = entries[entry].next) {
+            waiting.push_back(entries[entry].due);
+            waiting.push_back(entries[entry].event.kind);
+            waiting.push_back(entries[entry].event.payload);
+        }
+    }
+
+    writer.write(clock);
+    writer.writeArray(waiting);
+}
+
+void TimingWheel::loadState(SnapshotReader& reader, const std::vector<uint32_t>& limits) {
+    uint32_t loadedClock = reader.read<uint32_t>();
+    std::vector<uint32_t> waiting;
+    reader.readArray(waiting);
+    if (waiting.size() % 3 != 0) {
+        SnapshotReader::fail("save has a bad timed event");
+    }
+    for (size_t i = 0; i < waiting.size(); i += 3) {
+        uint32_t kind = waiting[i + 1];
+        if (waiting[i] <= loadedClock || kind >= limits.size() || waiting[i + 2] >= limits[kind]) {
+            SnapshotReader::fail("save has a bad timed event");
+        }
+    }
+
+    *this = TimingWheel();
+    clock = loadedClock;
+    for (size_t i = 0; i < waiting.size(); i += 3) {
+        schedule(waiting[i], TimedEvent{waiting[i + 1], waiting[i + 2]});
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// What falls due: a kind, which the wheel's owner defines, and a payload
+// such as an enemy or room id
+struct TimedEvent {
+    uint32_t kind;
+    uint32_t payload;
+
+    bool operator<(const TimedEvent& other) const {
+        return kind != other.kind ? kind < other.kind : payload < other.payload;
+    }
+};
+
+// A hierarchical timing wheel keyed on the turn: events are filed under
+// the turn they fall due, and advancing the clock only
+// touches the slot for the new turn, plus, every 64 turns, the events
+// filed further out as they cascade down a level. Scheduling and firing
+// an event are O(1) however many events are waiting.
+//
+// Slots are intrusive lists threaded through one pool of entries, so the
+// whole wheel is a few flat arrays and copying it for a fork is cheap.
+class TimingWheel {
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = uint32_t(1) << SLOT_BITS;
+    static constexpr unsigned LEVELS = 4;    // covers 2^24 turns; later events wait in overflow
+    static constexpr uint32_t OVERFLOW_SLOT = LEVELS * SLOTS;
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    struct Entry {
+        uint32_t due;
+        TimedEvent event;
+        uint32_t next;      // in its slot's list, or the free list
+    };
+
+    uint32_t clock;
+    size_t count;
+    std::vector<uint32_t> heads;    // by level * SLOTS + slot, then overflow; empty until first used
+    std::vector<Entry> entries;
+    uint32_t freeEntries;
+
+    void file(uint32_t entry);
+    uint32_t takeSlot(uint32_t slot);
+    void cascade();
+
+public:
+    TimingWheel() : clock(0), count(0), freeEntries(NO_ENTRY) {}
+
+    uint32_t now() const { return clock; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Files event to fire at turn due, which must be later than now()
+    void schedule(uint32_t due, TimedEvent event);
+
+    // Moves the clock forward to turn, appending every event that falls
+    // due on the way, in no particular order
+    void advanceTo(uint32_t turn, std::vector<TimedEvent>& due);
+
+    // Save games: the clock and every waiting event. limits holds one past
+    // the largest valid payload for each kind; kinds past its end are
+    // invalid.
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader, const std::vector<uint32_t>& limits);
+};
@@ -0,0 +1,56 @@
+#include "TriggerTable.h"
+#include "StateHash.h"
+
+size_t TriggerTable::hashOf(TriggerEvent event, ItemId item, RoomId room) {
+    return static_cast<size_t>(hashMix(static_cast<uint64_t>(event), (uint64_t(room) << 32) | item));
+}
+
+const TriggerRule* TriggerTable::probe(TriggerEvent event, ItemId item, RoomId room) const {
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = hashOf(event, item, room) & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+        const TriggerRule& rule = rules[slots[slot] - 1];
+        if (rule.event == event && rule.item == item && rule.room == room) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+void TriggerTable::insert(uint32_t rule) {
+    const size_t mask = slots.size() - 1;
+    size_t slot = hashOf(rules[rule].event, rules[rule].item, rules[rule].room) & mask;
+    while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = rule + 1;
+}
+
+void TriggerTable::reserve(size_t count) {
+    rules.reserve(count);
+    growSlots(count);
+}
+
+void TriggerTable::growSlots(size_t count) {
+    // Kept at most half full, so probes stay short
+    size_t wanted = 16;
+    while (wanted < count * 2) {
+        wanted *= 2;
+    }
+    if (wanted <= slots.size()) return;
+    slots.assign(wanted, 0);
+    for (uint32_t rule = 0; rule < rules.size(); ++rule) {
+        insert(rule);
+    }
+}
+
+bool TriggerTable::add(const TriggerRule& rule) {
+    if (!rules.empty() && probe(rule.event, rule.item, rule.room)) {
+        return false;
+    }
+    // Slots double when half full and rules grow geometrically, so adding
+    // rule by rule stays linear
+    growSlots(rules.size() + 1);
+    rules.push_back(rule);
+    insert(static_cast<uint32_t>(rules.size() - 1));
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Direction.h"
+#include "FlagSet.h"
+#include "Item.h"
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// What a trigger rule reacts to
+enum class TriggerEvent : uint8_t {
+    TAKE,       // the player picks an item up
+    USE,        // the player uses an item
+    ENTER       // the player arrives in a room
+};
+
+// When event happens with item (NO_ITEM for ENTER) in room (NO_ROOM for
+// anywhere), the effects apply to the player and the room they are in
+struct TriggerRule {
+    TriggerEvent event;
+    ItemId item;
+    RoomId room;
+    std::string_view message;       // printed when the rule fires
+    std::string_view specialEvent;  // becomes the room's special event
+    ExitRow opens;                  // exits that open in the room, NO_ROOM elsewhere
+    MemoryId memory;                // recovered, or NO_MEMORY
+};
+
+// The content's trigger rules, indexed by (event, item, room) in an
+// open-addressing hash table, so finding the rule for something the player
+// did is one probe for the room and one for anywhere, however many rules
+// there are. A rule for the room wins over one for anywhere.
+class TriggerTable {
+private:
+    std::vector<TriggerRule> rules;
+    std::vector<uint32_t> slots;    // rule index + 1, or 0 when empty; a power of two long
+
+    static size_t hashOf(TriggerEvent event, ItemId item, RoomId room);
+    const TriggerRule* probe(TriggerEvent event, ItemId item, RoomId room) const;
+    void insert(uint32_t rule);
+    // Makes room in slots for count rules, rehashing if it grows
+    void growSlots(size_t count);
+
+public:
+    // Adds a rule; returns false, adding nothing, if one with the same
+    // event, item and room is already there
+    bool add(const TriggerRule& rule);
+    // For callers that know how many rules are coming
+    void reserve(size_t count);
+
+    // The rule for event with item in room, or nullptr
+    const TriggerRule* find(TriggerEvent event, ItemId item, RoomId room) const {
+        if (rules.empty()) return nullptr;
+        const TriggerRule* rule = probe(event, item, room);
+        return rule ? rule : probe(event, item, NO_ROOM);
+    }
+
+    size_t size() const { return rules.size(); }
+    const TriggerRule& operator[](size_t index) const { return rules[index]; }
+};
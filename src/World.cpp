@@ -0,0 +1,260 @@
+#include "World.h"
+#include "Snapshot.h"
+#include "StateHash.h"
+#include <algorithm>
+
+World::World()
+    : arena(std::make_shared<Arena>()), pages(std::make_shared<PageTable>()), enemies(std::make_shared<EnemyStore>()),
+      routes(std::make_shared<RouteTable>()), events(std::make_shared<TimingWheel>()), residentRooms(0),
+      residentBudget(DEFAULT_RESIDENT_ROOMS),
+      sweepPage(0) {}
+
+World::World(std::shared_ptr<const GameData> data, size_t residentBudget)
+    : data(data), arena(std::make_shared<Arena>()),
+      pages(std::make_shared<PageTable>((data->roomCount() + PAGE_SIZE - 1) / PAGE_SIZE)),
+      exits(data->exitTable(), data->roomCount()), enemies(std::make_shared<EnemyStore>()),
+      routes(std::make_shared<RouteTable>()), events(std::make_shared<TimingWheel>()), residentRooms(0),
+      residentBudget(std::max<size_t>(1, residentBudget)), sweepPage(0) {}
+
+RoomId World::findRoom(std::string_view id) const {
+    return data ? data->findRoom(id) : NO_ROOM;
+}
+
+RoomId World::findRoomByName(std::string_view name) const {
+    return data ? data->findRoomByName(name) : NO_ROOM;
+}
+
+std::string_view World::roomName(RoomId id) const {
+    return data->room(id).name;
+}
+
+World::Page& World::editPage(RoomId id) {
+    std::shared_ptr<Page>& page = editable(pages)[id >> PAGE_BITS];
+    if (!page) {
+        page = allocate<Page>();
+    }
+    return editableInArena(page);
+}
+
+std::shared_ptr<Room> World::build(RoomId id, const GameData::RoomData& roomData) const {
+    auto room = allocate<Room>(roomData.id, roomData.name, roomData.description);
+    room->setIndex(id);
+    room->setHazard(roomData.hazard);
+    room->setSpecialEvent(std::string(roomData.specialEvent));
+    room->setEncounterChance(roomData.encounterChance);
+    for (uint32_t i = 0; i < roomData.itemCount; ++i) {
+        room->addItem(&data->items[data->roomItem(roomData.firstItem + i)]);
+    }
+    return room;
+}
+
+void World::visit(RoomId id) {
+    const Page* current = pageOf(id);
+    size_t slot = slotOf(id);
+    if (current && current->visited[slot] && current->rooms[slot]) return;
+
+    bool firstVisit = !(current && current->visited[slot]);
+    GameData::RoomData roomData = data->room(id);
+    Page& page = editPage(id);
+    page.visited[slot] = true;
+    if (!page.rooms[slot]) {
+        page.rooms[slot] = build(id, roomData);
+        residentRooms++;
+    }
+
+    if (firstVisit) {
+        // Spawned last to first at the front of the room, so they list in
+        // order ahead of anything that wandered in before
+        for (uint32_t i = roomData.enemyCount; i > 0; --i) {
+            const Enemy& spec = data->enemies[data->roomEnemy(roomData.firstEnemy + i - 1)];
+            editable(enemies).spawnFirst(spec, id, spec.isRoaming());
+        }
+    }
+
+    if (residentRooms > residentBudget) {
+        evict(id);
+    }
+}
+
+Room& World::editRoom(RoomId id) {
+    Page& page = editPage(id);
+    size_t slot = slotOf(id);
+    if (!page.rooms[slot]) {
+        page.rooms[slot] = build(id, data->room(id));
+        residentRooms++;
+    }
+    page.changed[slot] = true;
+    return editableInArena(page.rooms[slot]);
+}
+
+void World::evict(RoomId keep) {
+    // A clock sweep over the pages, carrying on where the last one stopped
+    const size_t target = residentBudget - residentBudget / 4;
+    const size_t pageCount = pages->size();
+    for (size_t step = 0; step < pageCount && residentRooms > target; ++step) {
+        size_t index = (sweepPage + step) % pageCount;
+        const Page* page = (*pages)[index].get();
+        if (!page) continue;
+
+        auto droppable = [&](size_t slot) {
+            return page->rooms[slot] && !page->changed[slot] && index * PAGE_SIZE + slot != keep;
+        };
+        size_t slot = 0;
+        while (slot < PAGE_SIZE && !droppable(slot)) slot++;
+        if (slot == PAGE_SIZE) continue;
+
+        Page& owned = editableInArena(editable(pages)[index]);
+        page = &owned;
+        for (; slot < PAGE_SIZE && residentRooms > target; ++slot) {
+            if (droppable(slot)) {
+                owned.rooms[slot].reset();
+                residentRooms--;
+            }
+        }
+        sweepPage = index;
+    }
+}
+
+void World::setExit(RoomId from, Direction direction, RoomId to) {
+    RoomId oldTo = getExit(from, direction);
+    if (direction < Direction::NONE && oldTo != to) {
+        exits.set(from, direction, to);
+        if (!routes->empty()) {
+            editable(routes).exitChanged(exits, from, direction, oldTo, to);
+        }
+    }
+}
+
+Direction World::routeStep(RoomId from, RoomId to) {
+    return editable(routes).nextStep(exits, from, to);
+}
+
+void World::schedule(uint32_t due, Event kind, uint32_t payload) {
+    editable(events).schedule(due, TimedEvent{static_cast<uint32_t>(kind), payload});
+}
+
+void World::advanceTo(uint32_t turn, std::vector<TimedEvent>& due) {
+    // An empty wheel needs no copy; its clock catches up once it has events
+    if (events->empty()) return;
+    editable(events).advanceTo(turn, due);
+    std::sort(due.begin(), due.end());
+}
+
+void World::moveEnemy(EnemyId id, Random& rng, RoomId playerRoom, uint32_t turn) {
+    if (editable(enemies).wander(id, exits, rng, playerRoom)) {
+        schedule(turn + EnemyStore::moveDelay(rng), Event::ENEMY_MOVE, id);
+    }
+}
+
+void World::tick(Random& rng, RoomId playerRoom, uint32_t turn) {
+    // Skip the copy when a fork's enemies have nothing to do
+    if (enemies->needsHealing(playerRoom)) {
+        editable(enemies).heal(playerRoom);
+    }
+    if (enemies->hasNewRoamers()) {
+        std::vector<EnemyId> roamers;
+        editable(enemies).takeNewRoamers(roamers);
+        for (EnemyId id : roamers) {
+            schedule(turn + EnemyStore::moveDelay(rng), Event::ENEMY_MOVE, id);
+        }
+    }
+}
+
+void World::saveState(SnapshotWriter& writer) const {
+    std::vector<RoomId> visited, changed;
+    for (size_t index = 0; index < pages->size(); ++index) {
+        const Page* page = (*pages)[index].get();
+        if (!page) continue;
+        for (size_t slot = 0; slot < PAGE_SIZE; ++slot) {
+            RoomId id = static_cast<RoomId>(index * PAGE_SIZE + slot);
+            if (page->visited[slot]) visited.push_back(id);
+            if (page->changed[slot]) changed.push_back(id);
+        }
+    }
+
+    writer.writeArray(visited);
+    writer.write(static_cast<uint32_t>(changed.size()));
+    for (RoomId id : changed) {
+        writer.write(id);
+        room(id).saveState(writer);
+    }
+
+    // Exit rows that differ from the game data's, in room order
+    std::vector<RoomId> changedRows;
+    for (const auto& entry : exits.changedRows()) {
+        changedRows.push_back(entry.first);
+    }
+    std::sort(changedRows.begin(), changedRows.end());
+    writer.write(static_cast<uint32_t>(changedRows.size()));
+    for (RoomId id : changedRows) {
+        writer.write(id);
+        writer.write(exits[id]);
+    }
+
+    enemies->saveState(writer);
+    events->saveState(writer);
+}
+
+void World::loadState(SnapshotReader& reader, const GameData& data) {
+    std::vector<RoomId> visited;
+    reader.readArray(visited);
+    for (RoomId id : visited) {
+        if (id >= size()) SnapshotReader::fail("save has a visit to an unknown room");
+        editPage(id).visited[slotOf(id)] = true;
+    }
+
+    uint32_t changedCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < changedCount; ++i) {
+        RoomId id = reader.read<RoomId>();
+        if (id >= size()) SnapshotReader::fail("save changes an unknown room");
+        editRoom(id).loadState(reader, data);
+    }
+
+    uint32_t rowCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < rowCount; ++i) {
+        RoomId id = reader.read<RoomId>();
+        ExitRow row = reader.read<ExitRow>();
+        if (id >= size()) SnapshotReader::fail("save changes the exits of an unknown room");
+        for (size_t direction = 0; direction < DIRECTION_COUNT; ++direction) {
+            if (row[direction] != NO_ROOM && row[direction] >= size()) {
+                SnapshotReader::fail("save has an exit to an unknown room");
+            }
+            exits.set(id, static_cast<Direction>(direction), row[direction]);
+        }
+    }
+
+    editable(enemies).loadState(reader, size());
+    // Payload limits by Event kind: enemies, then rooms for the rest
+    uint32_t roomCount = static_cast<uint32_t>(size());
+    editable(events).loadState(reader, {static_cast<uint32_t>(enemies->size()), roomCount, roomCount});
+
+    // Cached routes describe the old exits
+    if (!routes->empty()) {
+        routes = std::make_shared<RouteTable>();
+    }
+}
+
+uint64_t World::hashState() const {
+    uint64_t hash = enemies->hashState();
+
+    // Rooms as built hash alike whether resident or not, so only changed ones count
+    for (size_t index = 0; index < pages->size(); ++index) {
+        const Page* page = (*pages)[index].get();
+        if (!page || page->changed.none()) continue;
+        for (size_t slot = 0; slot < PAGE_SIZE; ++slot) {
+            if (page->changed[slot]) {
+                hash = hashMix(hash, index * PAGE_SIZE + slot);
+                hash = hashMix(hash, page->rooms[slot]->hashState());
+            }
+        }
+    }
+
+    // Summed, since the changed rows are kept in no particular order
+    uint64_t exitSum = 0;
+    for (const auto& entry : exits.changedRows()) {
+        const ExitRow& row = entry.second;
+        uint64_t rowHash = hashMix(entry.first, (uint64_t(row[0]) << 32) | row[1]);
+        exitSum += hashMix(rowHash, (uint64_t(row[2]) << 32) | row[3]);
+    }
+    return hashMix(hash, exitSum);
+}
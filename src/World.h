@@ -0,0 +1,164 @@
+#pragma once
+#include "Room.h"
+#include "EnemyStore.h"
+#include "ExitTable.h"
+#include "FileManager.h"
+#include "Random.h"
+#include "Direction.h"
+#include "RouteTable.h"
+#include "TimingWheel.h"
+#include "Arena.h"
+#include <array>
+#include <bitset>
+#include <vector>
+#include <memory>
+#include <string_view>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// The room graph. Rooms have dense RoomIds, their index in the game data,
+// and exits live in one flat table (see ExitTable), so following an exit
+// is two array loads. The world also owns every enemy, kept per room in an
+// EnemyStore, caches shortest routes between rooms in a RouteTable kept up
+// to date as exits change, and files what happens at later turns on a
+// TimingWheel.
+//
+// Rooms are built from the game data as they are needed: the first visit
+// makes a room's Room object, with its items, and spawns its enemies.
+// Rooms nobody has visited cost nothing beyond a share of one page-table
+// slot, so a world of millions of rooms starts as fast as one of ten.
+// Once more rooms are resident than the budget allows, rooms that have not
+// changed since they were built are dropped, to be built again if the
+// player comes back; changed rooms are kept.
+//
+// Copying a World is a copy-on-write fork: the copy shares every page of
+// rooms, the changed exits, the enemies, the routes and the timed events
+// with the original, and a part is only duplicated the first time one side
+// changes it. That is why mutation goes through visit()/editRoom()/
+// editEnemies() rather than plain getters.
+//
+// Pages and rooms come from an Arena made with the world and shared with
+// its forks, so they sit together in a few large buffers rather than
+// scattered over the heap, and go back in one piece with the last fork.
+class World {
+public:
+    static constexpr size_t DEFAULT_RESIDENT_ROOMS = 4096;
+
+    // What a timed event does when it falls due. The world moves enemies
+    // itself (see moveEnemy()); GameEngine::advanceTurn dispatches them all.
+    enum class Event : uint32_t {
+        ENEMY_MOVE,     // payload: the wandering enemy
+        HAZARD,         // payload: a room whose hazard hurts the player if still there
+        ENCOUNTER       // payload: a room whose encounter chance is rolled if the player is still there
+    };
+
+private:
+    static constexpr size_t PAGE_BITS = 4;
+    static constexpr size_t PAGE_SIZE = size_t(1) << PAGE_BITS;
+
+    // PAGE_SIZE consecutive rooms, made when the first of them is visited
+    struct Page {
+        std::array<std::shared_ptr<Room>, PAGE_SIZE> rooms;  // resident ones
+        std::bitset<PAGE_SIZE> visited;
+        std::bitset<PAGE_SIZE> changed;                      // edited since built, so never dropped
+    };
+    using PageTable = std::vector<std::shared_ptr<Page>>;
+
+    std::shared_ptr<const GameData> data;
+    std::shared_ptr<Arena> arena;
+    std::shared_ptr<PageTable> pages;               // indexed by RoomId / PAGE_SIZE
+    ExitTable exits;
+    std::shared_ptr<EnemyStore> enemies;
+    std::shared_ptr<RouteTable> routes;
+    std::shared_ptr<TimingWheel> events;
+    size_t residentRooms;
+    size_t residentBudget;
+    size_t sweepPage;                               // where the next eviction starts
+
+    // Makes the pointee private to this world before it is changed
+    template <typename T>
+    static T& editable(std::shared_ptr<T>& shared) {
+        if (shared.use_count() > 1) {
+            shared = std::make_shared<T>(*shared);
+        }
+        return *shared;
+    }
+
+    // Pages and rooms come from the arena, and keep it alive
+    template <typename T, typename... Args>
+    std::shared_ptr<T> allocate(Args&&... args) const {
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+    }
+    // Like editable(), for pages and rooms, which live in the arena
+    template <typename T>
+    T& editableInArena(std::shared_ptr<T>& shared) const {
+        if (shared.use_count() > 1) {
+            shared = allocate<T>(*shared);
+        }
+        return *shared;
+    }
+
+    static size_t slotOf(RoomId id) { return id & (PAGE_SIZE - 1); }
+    const Page* pageOf(RoomId id) const { return (*pages)[id >> PAGE_BITS].get(); }
+    Page& editPage(RoomId id);
+    std::shared_ptr<Room> build(RoomId id, const GameData::RoomData& roomData) const;
+    // Drops unchanged rooms other than keep until a quarter of the budget is free
+    void evict(RoomId keep);
+
+public:
+    World();
+    explicit World(std::shared_ptr<const GameData> data, size_t residentBudget = DEFAULT_RESIDENT_ROOMS);
+
+    // Lookups by string id, or by display name given in lowercase
+    RoomId findRoom(std::string_view id) const;
+    RoomId findRoomByName(std::string_view name) const;
+
+    size_t size() const { return exits.size(); }
+    size_t residentCount() const { return residentRooms; }
+    // Any room's name, without building it
+    std::string_view roomName(RoomId id) const;
+    bool isVisited(RoomId id) const {
+        const Page* page = pageOf(id);
+        return page && page->visited[slotOf(id)];
+    }
+
+    // Marks a room visited and makes it resident; the first visit spawns
+    // its enemies, roaming ones ready to wander
+    void visit(RoomId id);
+    // A resident room; the one the player is in always is
+    const Room& room(RoomId id) const { return *pageOf(id)->rooms[slotOf(id)]; }
+    // Any room, built if need be and kept resident from then on
+    Room& editRoom(RoomId id);
+
+    // Navigation
+    void setExit(RoomId from, Direction direction, RoomId to);
+    RoomId getExit(RoomId from, Direction direction) const {
+        return direction < Direction::NONE ? exits[from][static_cast<size_t>(direction)] : NO_ROOM;
+    }
+    const ExitRow& getExits(RoomId id) const { return exits[id]; }
+    // Next exit on a shortest route, or Direction::NONE if there is none
+    Direction routeStep(RoomId from, RoomId to);
+    
+    // Enemies
+    const EnemyStore& getEnemies() const { return *enemies; }
+    EnemyStore& editEnemies() { return editable(enemies); }
+    
+    // Save games: which rooms were visited, the rooms and exits that
+    // changed, enemies and timed events. Loading expects a world freshly
+    // built from the same game data.
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader, const GameData& data);
+    uint64_t hashState() const;
+    
+    // Timed events, due at a turn of the session
+    void schedule(uint32_t due, Event kind, uint32_t payload);
+    // Collects the events due by turn, ordered by kind and then payload so
+    // a save game replays them the same
+    void advanceTo(uint32_t turn, std::vector<TimedEvent>& due);
+    // An ENEMY_MOVE fell due: the enemy wanders and its next move is filed
+    void moveEnemy(EnemyId id, Random& rng, RoomId playerRoom, uint32_t turn);
+    // The rest of the turn-th turn: enemies heal, and those that started
+    // roaming since the last one get their first move
+    void tick(Random& rng, RoomId playerRoom, uint32_t turn);
+};
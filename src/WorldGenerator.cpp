@@ -0,0 +1,380 @@
+#include "WorldGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Rooms in one zone, a square of the grid, share a biome
+const size_t ZONE_SIZE = 16;
+// Chances per room, out of 100 unless noted
+const uint64_t LOOT_PERCENT = 12;
+const uint64_t ENEMY_PERCENT = 2;
+const uint64_t LOOP_PERCENT = 10;
+const uint64_t CHAMBER_ONE_IN = 64;    // of the dead ends
+
+// Separate rolls for each decision about a room
+enum class Roll : uint64_t {
+    TREE,
+    LOOP,
+    CHAMBER,
+    BIOME,
+    NAME,
+    LOOT,
+    LOOT_PICK,
+    ENEMY,
+    ENEMY_PICK
+};
+
+struct Biome {
+    std::string_view names[3];
+    std::string_view description;
+    Room::HazardType hazard;
+    int encounterChance;
+};
+
+// Names stay short enough to be stored inline in a Room's strings
+const Biome BIOMES[] = {
+    {{"Misty Forest", "Dark Thicket", "Old Grove"},
+     "Dense fog swirls between ancient trees. The forest feels alive with whispers of the past.",
+     Room::HazardType::NONE, 30},
+    {{"Ruined Street", "Burnt Square", "Broken Gate"},
+     "Collapsed houses and broken carts litter the area. A sense of ancient tragedy hangs in the air.",
+     Room::HazardType::NONE, 10},
+    {{"Damp Tunnel", "Dripping Cave", "Deep Grotto"},
+     "Dark tunnels stretch into the depths. Water drips steadily from stalactites. The air is cold and damp.",
+     Room::HazardType::COLD, 40},
+    {{"Fetid Marsh", "Sunken Bog", "Rotting Fen"},
+     "Black water bubbles between tufts of dead grass. Every breath of the vapour burns.",
+     Room::HazardType::POISON, 30},
+    {{"Silent Crypt", "Bone Hall", "Ossuary"},
+     "Rows of empty tombs line the walls. Dark energy pervades this place. Your soul feels heavy.",
+     Room::HazardType::CURSED, 50},
+    {{"Ash Field", "Lava Vent", "Scorched Ridge"},
+     "Cracks in the ground glow with heat. Ash drifts down like grey snow.",
+     Room::HazardType::HOT, 20},
+    {{"Quiet Meadow", "Windy Hill", "Stone Circle"},
+     "Tall grass sways under an empty sky. For a moment the ruined world seems at peace.",
+     Room::HazardType::NONE, 0},
+    {{"Temple Ruins", "Broken Shrine", "Old Chapel"},
+     "Crumbling stone pillars support a partially collapsed roof. Ancient runes glow faintly on the walls.",
+     Room::HazardType::NONE, 0},
+};
+const size_t BIOME_COUNT = sizeof(BIOMES) / sizeof(BIOMES[0]);
+
+const std::string_view START_NAME = "Wrecked Village";
+const std::string_view START_DESCRIPTION =
+    "You stand in the ruins of what was once a thriving village. Collapsed houses and broken carts litter the area.";
+const std::string_view CHAMBER_NAME = "Hidden Chamber";
+const std::string_view CHAMBER_DESCRIPTION =
+    "A secret chamber revealed by an ancient key. Mystical energy fills the air.";
+
+// Special event of a room once its key is used, by the opened exit's Direction
+const std::string_view UNLOCK_TEXT[DIRECTION_COUNT] = {
+    "You unlock a hidden chamber! A passage opens to the north.",
+    "You unlock a hidden chamber! A passage opens to the south.",
+    "You unlock a hidden chamber! A passage opens to the east.",
+    "You unlock a hidden chamber! A passage opens to the west.",
+};
+
+uint64_t splitmix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// The map: which rooms are joined and which are chambers, each answered
+// from the seed alone so any thread can ask about any room
+class Layout {
+private:
+    uint64_t seed;
+    size_t count;
+    size_t width;
+    bool chambers;      // the content has a key to lock them with
+
+public:
+    Layout(uint64_t seed, size_t count, bool chambers)
+        : seed(seed), count(count), width(static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))))),
+          chambers(chambers) {}
+
+    uint64_t roll(size_t room, Roll kind) const {
+        return splitmix(splitmix(seed ^ static_cast<uint64_t>(kind)) + room);
+    }
+
+    size_t row(size_t room) const { return room / width; }
+    size_t column(size_t room) const { return room % width; }
+
+    // The neighbour in a direction, or NO_ROOM off the grid
+    size_t neighbour(size_t room, Direction direction) const {
+        switch (direction) {
+            case Direction::NORTH: return row(room) > 0 ? room - width : NO_ROOM;
+            case Direction::SOUTH: return room + width < count ? room + width : NO_ROOM;
+            case Direction::EAST: return column(room) + 1 < width && room + 1 < count ? room + 1 : NO_ROOM;
+            case Direction::WEST: return column(room) > 0 ? room - 1 : NO_ROOM;
+            default: return NO_ROOM;
+        }
+    }
+
+    // Every room but the first joins the tree through its north or west
+    // neighbour, which is always one step closer to the first room
+    Direction treeParent(size_t room) const {
+        if (room == 0) return Direction::NONE;
+        if (row(room) == 0) return Direction::WEST;
+        if (column(room) == 0) return Direction::NORTH;
+        return roll(room, Roll::TREE) & 1 ? Direction::NORTH : Direction::WEST;
+    }
+
+    bool isDeadEnd(size_t room) const {
+        size_t south = neighbour(room, Direction::SOUTH);
+        size_t east = neighbour(room, Direction::EAST);
+        return (south == NO_ROOM || treeParent(south) != Direction::NORTH) &&
+               (east == NO_ROOM || treeParent(east) != Direction::WEST);
+    }
+
+    // Reachable only through its tree parent, which holds the key
+    bool isChamber(size_t room) const {
+        return chambers && room != 0 && isDeadEnd(room) && roll(room, Roll::CHAMBER) % CHAMBER_ONE_IN == 0;
+    }
+
+    // A second way out through the other of north and west, making loops;
+    // never into or out of a chamber
+    Direction loop(size_t room) const {
+        if (row(room) == 0 || column(room) == 0 || roll(room, Roll::LOOP) % 100 >= LOOP_PERCENT) {
+            return Direction::NONE;
+        }
+        Direction other = treeParent(room) == Direction::NORTH ? Direction::WEST : Direction::NORTH;
+        if (isChamber(room) || isChamber(neighbour(room, other))) return Direction::NONE;
+        return other;
+    }
+
+    // Whether room is joined to its north or west neighbour
+    bool joinedBack(size_t room, Direction direction) const {
+        return treeParent(room) == direction || loop(room) == direction;
+    }
+
+    const Biome& biome(size_t room) const {
+        size_t zone = (row(room) / ZONE_SIZE) * (width / ZONE_SIZE + 1) + column(room) / ZONE_SIZE;
+        return BIOMES[roll(zone, Roll::BIOME) % BIOME_COUNT];
+    }
+};
+
+// Items and enemies of the content the generator places
+struct Palette {
+    std::vector<uint32_t> loot;     // everything but keys
+    uint32_t key = NO_ITEM;
+    std::string_view unlockMessage; // shown when the key opens a chamber
+    uint32_t starterWeapon = NO_ITEM;
+    uint32_t potion = NO_ITEM;
+    uint32_t bestWeapon = NO_ITEM;
+    uint32_t boss = UINT32_MAX;
+};
+
+Palette paletteOf(const GameData& content) {
+    Palette palette;
+    for (uint32_t i = 0; i < content.items.size(); ++i) {
+        const Item& item = content.items[i];
+        switch (item.getType()) {
+            case Item::Type::KEY:
+                if (palette.key == NO_ITEM) palette.key = i;
+                continue;
+            case Item::Type::WEAPON:
+                if (palette.starterWeapon == NO_ITEM) palette.starterWeapon = i;
+                if (palette.bestWeapon == NO_ITEM || item.getEffect() > content.items[palette.bestWeapon].getEffect()) {
+                    palette.bestWeapon = i;
+                }
+                break;
+            case Item::Type::POTION:
+                if (palette.potion == NO_ITEM) palette.potion = i;
+                break;
+            default:
+                break;
+        }
+        palette.loot.push_back(i);
+    }
+    for (uint32_t i = 0; i < content.enemies.size(); ++i) {
+        if (content.enemies[i].getType() == Enemy::Type::BOSS) {
+            palette.boss = i;
+            break;
+        }
+    }
+    return palette;
+}
+
+// One thread's share of the rooms. Item and enemy ranges are local to the
+// chunk until the chunks are joined.
+struct Chunk {
+    size_t begin, end;
+    std::vector<uint32_t> roomItems;
+    std::vector<uint32_t> roomEnemies;
+    std::vector<TriggerRule> triggers;  // the chunk's locks
+};
+
+void writeId(char* out, size_t digits, size_t room) {
+    out[0] = 'r';
+    for (size_t i = digits; i > 0; --i) {
+        out[i] = static_cast<char>('0' + room % 10);
+        room /= 10;
+    }
+}
+
+// Fills in the chunk's rooms and exit rows; chunks touch disjoint rooms
+void generateChunk(const Layout& layout, const Palette& palette, GameData& data, Chunk& chunk,
+                   char* ids, size_t idLength) {
+    size_t count = data.rooms.size();
+    for (size_t index = chunk.begin; index < chunk.end; ++index) {
+        GameData::RoomData& room = data.rooms[index];
+        ExitRow& exits = data.exits[index];
+        writeId(ids + index * idLength, idLength - 1, index);
+        room.id = std::string_view(ids + index * idLength, idLength);
+        exits.fill(NO_ROOM);
+        room.firstItem = static_cast<uint32_t>(chunk.roomItems.size());
+        room.firstEnemy = static_cast<uint32_t>(chunk.roomEnemies.size());
+
+        auto addItem = [&](uint32_t item) {
+            if (item == NO_ITEM) return;
+            chunk.roomItems.push_back(item);
+            room.itemCount++;
+        };
+        auto addEnemy = [&](uint32_t enemy) {
+            chunk.roomEnemies.push_back(enemy);
+            room.enemyCount++;
+        };
+
+        // Exits: north and west by this room's choices, south and east by
+        // its neighbours'. Chambers keep their way out; the way in opens
+        // when the key is used here.
+        TriggerRule lock{TriggerEvent::USE, palette.key, static_cast<RoomId>(index), palette.unlockMessage, {}, {}, NO_MEMORY};
+        lock.opens.fill(NO_ROOM);
+        for (Direction direction : {Direction::NORTH, Direction::WEST}) {
+            if (layout.joinedBack(index, direction)) {
+                exits[static_cast<size_t>(direction)] = static_cast<RoomId>(layout.neighbour(index, direction));
+            }
+        }
+        for (Direction direction : {Direction::SOUTH, Direction::EAST}) {
+            size_t next = layout.neighbour(index, direction);
+            if (next == NO_ROOM || !layout.joinedBack(next, oppositeDirection(direction))) continue;
+            if (layout.isChamber(next)) {
+                lock.opens[static_cast<size_t>(direction)] = static_cast<RoomId>(next);
+                lock.specialEvent = UNLOCK_TEXT[static_cast<size_t>(direction)];
+            } else {
+                exits[static_cast<size_t>(direction)] = static_cast<RoomId>(next);
+            }
+        }
+
+        if (!lock.specialEvent.empty()) {
+            chunk.triggers.push_back(lock);
+            addItem(palette.key);
+        }
+
+        if (index == 0) {
+            room.name = START_NAME;
+            room.description = START_DESCRIPTION;
+            room.hazard = Room::HazardType::NONE;
+            addItem(palette.starterWeapon);
+            addItem(palette.potion);
+            continue;
+        }
+
+        if (layout.isChamber(index)) {
+            room.name = CHAMBER_NAME;
+            room.description = CHAMBER_DESCRIPTION;
+            room.hazard = Room::HazardType::NONE;
+            addItem(palette.bestWeapon);
+        } else {
+            const Biome& biome = layout.biome(index);
+            room.name = biome.names[layout.roll(index, Roll::NAME) % 3];
+            room.description = biome.description;
+            room.hazard = biome.hazard;
+            room.encounterChance = data.encounters.empty() ? 0 : biome.encounterChance;
+        }
+
+        if (!palette.loot.empty() && layout.roll(index, Roll::LOOT) % 100 < LOOT_PERCENT) {
+            addItem(palette.loot[layout.roll(index, Roll::LOOT_PICK) % palette.loot.size()]);
+        }
+
+        if (index == count - 1 && palette.boss != UINT32_MAX) {
+            addEnemy(palette.boss);
+        } else if (!data.encounters.empty() && room.encounterChance > 0 &&
+                   layout.roll(index, Roll::ENEMY) % 100 < ENEMY_PERCENT) {
+            addEnemy(data.encounters[layout.roll(index, Roll::ENEMY_PICK) % data.encounters.size()]);
+        }
+    }
+}
+
+} // namespace
+
+std::shared_ptr<const GameData> WorldGenerator::generate(std::shared_ptr<GameData> content, size_t roomCount,
+                                                         uint64_t seed, unsigned threads) {
+    if (roomCount == 0 || roomCount >= NO_ROOM) {
+        throw std::runtime_error("Cannot generate a world of " + std::to_string(roomCount) + " rooms");
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    GameData& data = *content;
+    Layout layout(seed, roomCount, true);
+    Palette palette = paletteOf(data);
+    if (palette.key == NO_ITEM) {
+        layout = Layout(seed, roomCount, false);
+    }
+
+    // What the world was made from goes into the fingerprint with the content
+    data.sources.push_back("generated rooms=" + std::to_string(roomCount) + " seed=" + std::to_string(seed) + "\n");
+    if (palette.key != NO_ITEM) {
+        palette.unlockMessage = data.sources.emplace_back("The " + data.items[palette.key].getName() +
+                                                          " fits perfectly! A hidden passage opens.");
+    }
+
+    // Fixed-width ids, "r" and the zero-padded index, in one buffer
+    size_t digits = std::to_string(roomCount - 1).size();
+    size_t idLength = digits + 1;
+    std::string& ids = data.sources.emplace_back(roomCount * idLength, '\0');
+
+    data.rooms.assign(roomCount, GameData::RoomData{});
+    data.exits.resize(roomCount);
+
+    size_t chunkCount = std::min<size_t>(threads, (roomCount + 4095) / 4096);
+    std::vector<Chunk> chunks(chunkCount);
+    size_t perChunk = (roomCount + chunkCount - 1) / chunkCount;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        chunks[c].begin = std::min(roomCount, c * perChunk);
+        chunks[c].end = std::min(roomCount, (c + 1) * perChunk);
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t c = 1; c < chunkCount; ++c) {
+        workers.emplace_back(generateChunk, std::cref(layout), std::cref(palette), std::ref(data),
+                             std::ref(chunks[c]), &ids[0], idLength);
+    }
+    generateChunk(layout, palette, data, chunks[0], &ids[0], idLength);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Join the chunks' item and enemy lists, moving their ranges to match,
+    // and their locks
+    size_t lockCount = 0;
+    for (const Chunk& chunk : chunks) {
+        lockCount += chunk.triggers.size();
+    }
+    data.triggers.reserve(data.triggers.size() + lockCount);
+    for (const Chunk& chunk : chunks) {
+        for (const TriggerRule& lock : chunk.triggers) {
+            data.triggers.add(lock);
+        }
+        uint32_t itemOffset = static_cast<uint32_t>(data.roomItems.size());
+        uint32_t enemyOffset = static_cast<uint32_t>(data.roomEnemies.size());
+        data.roomItems.insert(data.roomItems.end(), chunk.roomItems.begin(), chunk.roomItems.end());
+        data.roomEnemies.insert(data.roomEnemies.end(), chunk.roomEnemies.begin(), chunk.roomEnemies.end());
+        for (size_t index = chunk.begin; index < chunk.end; ++index) {
+            data.rooms[index].firstItem += itemOffset;
+            data.rooms[index].firstEnemy += enemyOffset;
+        }
+    }
+
+    FileManager::seal(data);
+    return content;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "FileManager.h"
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Generates worlds of any size for load and soak tests. Rooms sit on a
+// square grid joined by a random spanning tree plus a few extra loops, so
+// every room can be reached from the first. Zones of the grid take a
+// biome (names, description, hazard, encounter chance); some dead ends are
+// hidden chambers locked behind a key found next door, the way the
+// temple locks the chamber; loot and enemies are scattered about and the
+// boss waits in the last room.
+//
+// Every room is a pure function of the seed and its index, so rooms are
+// generated in parallel with no shared state and the result does not
+// depend on the thread count. Names and descriptions view static text;
+// the only per-room text stored is the room id.
+class WorldGenerator {
+public:
+    // Adds roomCount rooms to content (see FileManager::loadContent) and
+    // seals it. Uses every core when threads is 0.
+    static std::shared_ptr<const GameData> generate(std::shared_ptr<GameData> content, size_t roomCount,
+                                                    uint64_t seed, unsigned threads = 0);
+};
@@ -0,0 +1,380 @@
+#include "WorldImage.h"
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// "EFWI" followed by the format version
+struct WorldImage::Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t fingerprint;      // of the world compiled, so its save games load
+    uint64_t contentHash;      // of the items, enemies and memories the world refers to
+    uint32_t roomCount;
+    uint32_t itemCount;        // entries in the rooms' item lists
+    uint32_t enemyCount;       // entries in the rooms' enemy lists
+    uint32_t triggerCount;     // the world's own triggers, beyond the content's
+    uint32_t contentItems;
+    uint32_t contentEnemies;
+    uint32_t contentMemories;
+    uint32_t padding;
+    uint64_t textBytes;
+};
+
+struct WorldImage::TextRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct WorldImage::RoomRecord {
+    TextRef id;
+    TextRef name;
+    TextRef description;
+    TextRef specialEvent;
+    uint32_t firstItem, itemCount;
+    uint32_t firstEnemy, enemyCount;
+    uint8_t hazard;
+    uint8_t encounterChance;
+    uint8_t padding[2];
+};
+
+struct WorldImage::TriggerRecord {
+    TextRef message;
+    TextRef specialEvent;
+    ExitRow opens;
+    uint32_t item;
+    uint32_t room;
+    uint32_t memory;
+    uint8_t event;
+    uint8_t padding[3];
+};
+
+namespace {
+
+const char MAGIC[4] = {'E', 'F', 'W', 'I'};
+const uint32_t IMAGE_VERSION = 2;
+
+// Records are written this many at a time
+const size_t WRITE_BATCH = 4096;
+
+// FNV-1a over the names, types and text the world refers to by index
+uint64_t contentHashOf(const GameData& data) {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&](std::string_view text, uint8_t kind) {
+        hash = (hash ^ kind) * prime;
+        for (unsigned char c : text) {
+            hash = (hash ^ c) * prime;
+        }
+    };
+    for (const Item& item : data.items) {
+        add(item.getName(), static_cast<uint8_t>(item.getType()));
+    }
+    for (const Enemy& enemy : data.enemies) {
+        add(enemy.getName(), static_cast<uint8_t>(0x80 | static_cast<uint8_t>(enemy.getType())));
+    }
+    for (std::string_view memory : data.memories) {
+        add(memory, 0x40);
+    }
+    return hash;
+}
+
+template <typename T>
+void writeTable(std::ofstream& file, const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "tables are plain values");
+    file.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+} // namespace
+
+WorldImage::WorldImage(const std::string& path, const char* mapping, size_t length)
+    : path(path), mapping(mapping), length(length), header(nullptr), records(nullptr), exits(nullptr),
+      items(nullptr), enemies(nullptr), byId(nullptr), byName(nullptr), text(nullptr) {}
+
+WorldImage::~WorldImage() {
+    munmap(const_cast<char*>(mapping), length);
+}
+
+void WorldImage::fail(const std::string& message) const {
+    throw std::runtime_error(path + ": " + message);
+}
+
+void WorldImage::write(const GameData& data, const std::string& path) {
+    const size_t count = data.roomCount();
+    if (count >= NO_ROOM) {
+        throw std::runtime_error("World is too large for an image: " + std::to_string(count) + " rooms");
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = IMAGE_VERSION;
+    header.fingerprint = data.fingerprint;
+    header.contentHash = contentHashOf(data);
+    header.roomCount = static_cast<uint32_t>(count);
+    header.contentItems = static_cast<uint32_t>(data.items.size());
+    header.contentEnemies = static_cast<uint32_t>(data.enemies.size());
+    header.contentMemories = static_cast<uint32_t>(data.memories.size());
+    header.triggerCount = static_cast<uint32_t>(data.triggers.size() - data.contentTriggers);
+
+    // Written beside the target and renamed over it
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot write world image: " + temporary);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Ids are unique; everything else is mostly the same few texts, stored once
+    std::string textBuffer;
+    std::unordered_map<std::string_view, TextRef> storedText;
+    auto addText = [&](std::string_view value, bool unique) {
+        if (!unique) {
+            auto it = storedText.find(value);
+            if (it != storedText.end()) return it->second;
+        }
+        if (textBuffer.size() + value.size() > UINT32_MAX) {
+            throw std::runtime_error("World has too much text for an image");
+        }
+        TextRef ref{static_cast<uint32_t>(textBuffer.size()), static_cast<uint32_t>(value.size())};
+        textBuffer.append(value);
+        if (!unique) storedText.emplace(value, ref);
+        return ref;
+    };
+
+    std::vector<uint32_t> itemList, enemyList;
+    std::vector<RoomRecord> batch;
+    batch.reserve(WRITE_BATCH);
+    for (RoomId id = 0; id < count; ++id) {
+        GameData::RoomData room = data.room(id);
+        RoomRecord record{};
+        record.id = addText(room.id, true);
+        record.name = addText(room.name, false);
+        record.description = addText(room.description, false);
+        record.specialEvent = addText(room.specialEvent, false);
+        record.hazard = static_cast<uint8_t>(room.hazard);
+        record.encounterChance = static_cast<uint8_t>(room.encounterChance);
+
+        record.firstItem = static_cast<uint32_t>(itemList.size());
+        record.itemCount = room.itemCount;
+        for (uint32_t i = 0; i < room.itemCount; ++i) {
+            itemList.push_back(data.roomItem(room.firstItem + i));
+        }
+        record.firstEnemy = static_cast<uint32_t>(enemyList.size());
+        record.enemyCount = room.enemyCount;
+        for (uint32_t i = 0; i < room.enemyCount; ++i) {
+            enemyList.push_back(data.roomEnemy(room.firstEnemy + i));
+        }
+
+        batch.push_back(record);
+        if (batch.size() == WRITE_BATCH) {
+            writeTable(file, batch.data(), batch.size());
+            batch.clear();
+        }
+    }
+    writeTable(file, batch.data(), batch.size());
+
+    // The content's triggers come with the content
+    std::vector<TriggerRecord> triggers;
+    triggers.reserve(header.triggerCount);
+    for (size_t i = data.contentTriggers; i < data.triggers.size(); ++i) {
+        const TriggerRule& rule = data.triggers[i];
+        TriggerRecord record{};
+        record.message = addText(rule.message, false);
+        record.specialEvent = addText(rule.specialEvent, false);
+        record.opens = rule.opens;
+        record.item = rule.item;
+        record.room = rule.room;
+        record.memory = rule.memory;
+        record.event = static_cast<uint8_t>(rule.event);
+        triggers.push_back(record);
+    }
+    writeTable(file, triggers.data(), triggers.size());
+
+    writeTable(file, data.exitTable(), count);
+    writeTable(file, itemList.data(), itemList.size());
+    writeTable(file, enemyList.data(), enemyList.size());
+    writeTable(file, data.image ? data.image->roomsById() : data.roomsById.data(), count);
+    writeTable(file, data.image ? data.image->roomsByName() : data.roomsByName.data(), count);
+    file.write(textBuffer.data(), static_cast<std::streamsize>(textBuffer.size()));
+
+    // The counts are only known now
+    header.itemCount = static_cast<uint32_t>(itemList.size());
+    header.enemyCount = static_cast<uint32_t>(enemyList.size());
+    header.textBytes = textBuffer.size();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file.flush()) {
+        throw std::runtime_error("Cannot write world image: " + temporary);
+    }
+    file.close();
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace world image: " + path);
+    }
+}
+
+std::shared_ptr<const GameData> WorldImage::load(std::shared_ptr<GameData> content, const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open world image: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error(path + ": not a world image");
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map world image: " + path);
+    }
+    // Rooms are read in no particular order, and read-ahead would page in
+    // parts of the world nobody has asked for
+    madvise(mapping, length, MADV_RANDOM);
+    std::shared_ptr<WorldImage> image(new WorldImage(path, static_cast<const char*>(mapping), length));
+
+    const Header& header = *reinterpret_cast<const Header*>(image->mapping);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        image->fail("not a world image");
+    }
+    if (header.version != IMAGE_VERSION) {
+        image->fail("unsupported world image version " + std::to_string(header.version));
+    }
+    if (header.roomCount == 0 || header.roomCount == NO_ROOM) {
+        image->fail("world image has no rooms");
+    }
+    uint64_t rooms = header.roomCount;
+    uint64_t expected = sizeof(Header) + rooms * (sizeof(RoomRecord) + sizeof(ExitRow) + 2 * sizeof(RoomId)) +
+                        uint64_t(header.triggerCount) * sizeof(TriggerRecord) +
+                        (uint64_t(header.itemCount) + header.enemyCount) * sizeof(uint32_t) + header.textBytes;
+    if (header.textBytes > UINT32_MAX || expected != length) {
+        image->fail("world image is truncated or damaged");
+    }
+    if (header.contentHash != contentHashOf(*content) || header.contentItems != content->items.size() ||
+        header.contentEnemies != content->enemies.size() || header.contentMemories != content->memories.size()) {
+        image->fail("world image was compiled with different items, enemies or memories");
+    }
+
+    // The tables follow the header in order
+    const char* next = image->mapping + sizeof(Header);
+    auto table = [&next](auto*& pointer, uint64_t count) {
+        pointer = reinterpret_cast<std::remove_reference_t<decltype(pointer)>>(next);
+        next += count * sizeof(*pointer);
+    };
+    image->header = &header;
+    const TriggerRecord* triggers;
+    table(image->records, rooms);
+    table(triggers, header.triggerCount);
+    table(image->exits, rooms);
+    table(image->items, header.itemCount);
+    table(image->enemies, header.enemyCount);
+    table(image->byId, rooms);
+    table(image->byName, rooms);
+    image->text = next;
+
+    // Triggers are looked up by what the player does, not by room, so they
+    // join the content's table now rather than as rooms are read
+    auto roomInRange = [&header](RoomId to) { return to == NO_ROOM || to < header.roomCount; };
+    auto textIn = [&header, image](const TextRef& ref) {
+        if (ref.offset > header.textBytes || ref.length > header.textBytes - ref.offset) {
+            image->fail("world image has a trigger with text out of range");
+        }
+        return std::string_view(image->text + ref.offset, ref.length);
+    };
+    content->triggers.reserve(content->triggers.size() + header.triggerCount);
+    for (uint32_t i = 0; i < header.triggerCount; ++i) {
+        const TriggerRecord& record = triggers[i];
+        bool valid = record.event <= static_cast<uint8_t>(TriggerEvent::ENTER) &&
+                     (record.item == NO_ITEM || record.item < header.contentItems) && roomInRange(record.room) &&
+                     (record.memory == NO_MEMORY || record.memory < header.contentMemories);
+        for (size_t direction = 0; valid && direction < DIRECTION_COUNT; ++direction) {
+            valid = roomInRange(record.opens[direction]);
+        }
+        TriggerRule rule{static_cast<TriggerEvent>(record.event), record.item, record.room,
+                         textIn(record.message), textIn(record.specialEvent), record.opens, record.memory};
+        if (!valid || !content->triggers.add(rule)) {
+            image->fail("trigger " + std::to_string(i) + " is damaged");
+        }
+    }
+
+    content->image = image;
+    content->fingerprint = header.fingerprint;
+    return content;
+}
+
+size_t WorldImage::roomCount() const {
+    return header->roomCount;
+}
+
+const WorldImage::RoomRecord& WorldImage::record(RoomId id) const {
+    if (id >= header->roomCount) {
+        fail("world image has no room " + std::to_string(id));
+    }
+    return records[id];
+}
+
+std::string_view WorldImage::textOf(const TextRef& ref, RoomId id) const {
+    if (ref.offset > header->textBytes || ref.length > header->textBytes - ref.offset) {
+        fail("room " + std::to_string(id) + " has text out of range");
+    }
+    return std::string_view(text + ref.offset, ref.length);
+}
+
+GameData::RoomData WorldImage::room(RoomId id) const {
+    const RoomRecord& record = this->record(id);
+
+    auto roomInRange = [this](RoomId to) { return to == NO_ROOM || to < header->roomCount; };
+    bool valid = record.hazard <= static_cast<uint8_t>(Room::HazardType::HOT) && record.encounterChance <= 100 &&
+                 record.firstItem <= header->itemCount && record.itemCount <= header->itemCount - record.firstItem &&
+                 record.firstEnemy <= header->enemyCount && record.enemyCount <= header->enemyCount - record.firstEnemy;
+    for (size_t direction = 0; valid && direction < DIRECTION_COUNT; ++direction) {
+        valid = roomInRange(exits[id][direction]);
+    }
+    for (uint32_t i = 0; valid && i < record.itemCount; ++i) {
+        valid = items[record.firstItem + i] < header->contentItems;
+    }
+    for (uint32_t i = 0; valid && i < record.enemyCount; ++i) {
+        valid = enemies[record.firstEnemy + i] < header->contentEnemies;
+    }
+    if (!valid) {
+        fail("room " + std::to_string(id) + " is damaged");
+    }
+
+    GameData::RoomData room{};
+    room.id = textOf(record.id, id);
+    room.name = textOf(record.name, id);
+    room.description = textOf(record.description, id);
+    room.specialEvent = textOf(record.specialEvent, id);
+    room.hazard = static_cast<Room::HazardType>(record.hazard);
+    room.encounterChance = record.encounterChance;
+    room.firstItem = record.firstItem;
+    room.itemCount = record.itemCount;
+    room.firstEnemy = record.firstEnemy;
+    room.enemyCount = record.enemyCount;
+    return room;
+}
+
+std::string_view WorldImage::roomIdOf(RoomId id) const {
+    return textOf(record(id).id, id);
+}
+
+std::string_view WorldImage::roomNameOf(RoomId id) const {
+    return textOf(record(id).name, id);
+}
+
+uint32_t WorldImage::roomItem(uint32_t index) const {
+    if (index >= header->itemCount) fail("room item " + std::to_string(index) + " out of range");
+    return items[index];
+}
+
+uint32_t WorldImage::roomEnemy(uint32_t index) const {
+    if (index >= header->enemyCount) fail("room enemy " + std::to_string(index) + " out of range");
+    return enemies[index];
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "FileManager.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// A world compiled to one binary file that is mapped read-only, so loading
+// it takes the same time however many rooms it has: nothing is read until
+// a session visits a room, and the kernel only pages in the parts of the
+// file that are touched. The file holds flat tables (room records, the
+// exit table, the rooms' item and enemy lists, the lookup indexes), the
+// world's triggers and the text they refer to, in host byte order like
+// save games.
+//
+// Items, enemies and memories are not part of the image; the rooms and
+// triggers refer to them by index, so an image is loaded with the content
+// it was compiled from and refuses any other. Triggers are read when the
+// image is loaded. Rooms are checked as they are read rather than all up
+// front, and a damaged one throws std::runtime_error.
+class WorldImage {
+private:
+    struct Header;
+    struct RoomRecord;
+    struct TriggerRecord;
+    struct TextRef;
+
+    std::string path;
+    const char* mapping;
+    size_t length;
+    const Header* header;
+    const RoomRecord* records;
+    const ExitRow* exits;
+    const uint32_t* items;
+    const uint32_t* enemies;
+    const RoomId* byId;
+    const RoomId* byName;
+    const char* text;
+
+    WorldImage(const std::string& path, const char* mapping, size_t length);
+    std::string_view textOf(const TextRef& ref, RoomId id) const;
+    const RoomRecord& record(RoomId id) const;
+    [[noreturn]] void fail(const std::string& message) const;
+
+public:
+    ~WorldImage();
+    WorldImage(const WorldImage&) = delete;
+    WorldImage& operator=(const WorldImage&) = delete;
+
+    // Compiles data's rooms to an image at path, replacing the file whole
+    static void write(const GameData& data, const std::string& path);
+
+    // Maps the image at path and puts its rooms behind content (see
+    // FileManager::loadContent), which must be what it was compiled with
+    static std::shared_ptr<const GameData> load(std::shared_ptr<GameData> content, const std::string& path);
+
+    size_t roomCount() const;
+    GameData::RoomData room(RoomId id) const;
+    std::string_view roomIdOf(RoomId id) const;
+    std::string_view roomNameOf(RoomId id) const;
+    const ExitRow* exitTable() const { return exits; }
+    uint32_t roomItem(uint32_t index) const;
+    uint32_t roomEnemy(uint32_t index) const;
+    const RoomId* roomsById() const { return byId; }
+    const RoomId* roomsByName() const { return byName; }
+};
@@ -1,11 +1,370 @@
 #include "GameEngine.h"
+#include "GameIO.h"
+#include "GameServer.h"
+#include "BatchCombat.h"
+#include "FileManager.h"
+#include "Solver.h"
+#include "Journal.h"
+#include "Metrics.h"
+#include "WorldGenerator.h"
+#include "WorldImage.h"
+#include "SelfCheck.h"
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
 
-int main() {
+namespace {
+
+// How often --metrics rewrites its file while a session or server runs
+const std::chrono::seconds METRICS_INTERVAL(10);
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--seed N] [--data DIR] [--generate ROOMS] [--world FILE] [--compile-world FILE] [--script FILE] [--batch FILE [SESSIONS]] [--server ADDRESS] [--balance [FIGHTS]] [--solve [STATES]] [--selfcheck] [--record PATH] [--metrics FILE] [--replay FILE [RUNS]]" << std::endl;
+    std::cerr << "  (no options)          Play interactively" << std::endl;
+    std::cerr << "  --script FILE         Play one session reading commands from FILE" << std::endl;
+    std::cerr << "  --batch FILE [N]      Run N sessions (default 1000) of FILE in-process" << std::endl;
+    std::cerr << "  --server ADDRESS      Host sessions on tcp:PORT or unix:PATH" << std::endl;
+    std::cerr << "  --balance [FIGHTS]    Simulate FIGHTS (default 100000) fights per enemy and weapon" << std::endl;
+    std::cerr << "  --solve [STATES]      Print the shortest winning script for the seed, searching up to STATES states" << std::endl;
+    std::cerr << "  --selfcheck           Check incremental shortcuts against the slow way, over seeded random cases" << std::endl;
+    std::cerr << "  --replay FILE [RUNS]  Replay a recorded session, or time RUNS silent replays of it" << std::endl;
+    std::cerr << "  --seed N              Seed the random number generator for reproducible runs" << std::endl;
+    std::cerr << "  --data DIR            Load the world from DIR/rooms.txt, items.txt, enemies.txt, dialogues.txt, triggers.txt" << std::endl;
+    std::cerr << "  --generate ROOMS      Play in a world of ROOMS rooms generated from the seed (with --data, using DIR's items and enemies)" << std::endl;
+    std::cerr << "  --world FILE          Play in a world compiled with --compile-world (with --data, using DIR's items and enemies)" << std::endl;
+    std::cerr << "  --compile-world FILE  Compile the world (built-in, --data or --generate) to an image at FILE and exit" << std::endl;
+    std::cerr << "  --record PATH         Record the session to a journal at PATH (with --server, one per session in directory PATH)" << std::endl;
+    std::cerr << "  --metrics FILE        Time commands and count events, dumping them to FILE as JSON every 10 s and at exit" << std::endl;
+}
+
+void recordIfAsked(GameEngine& game, const std::string& journalPath, const GameData& data, uint64_t seed) {
+    if (!journalPath.empty()) {
+        game.recordTo(std::make_unique<JournalWriter>(journalPath, data, seed, 0));
+    }
+}
+
+int runInteractive(std::shared_ptr<const GameData> data, uint64_t seed, const std::string& journalPath, Metrics* metrics) {
+    StreamInput input(std::cin);
+    StreamSink output(std::cout);
+    GameEngine game(output, data, seed);
+    game.setSaveFile("savegame.dat");
+    recordIfAsked(game, journalPath, *data, seed);
+    game.measureTo(metrics);
+    game.allowAdminCommands();
+    game.startGame(input);
+    return 0;
+}
+
+int runScript(const std::string& filename, std::shared_ptr<const GameData> data, uint64_t seed, const std::string& journalPath, Metrics* metrics) {
+    auto lines = loadScript(filename);
+    ScriptInput input(lines);
+    StreamSink output(std::cout);
+    GameEngine game(output, data, seed);
+    recordIfAsked(game, journalPath, *data, seed);
+    game.measureTo(metrics);
+    game.allowAdminCommands();
+    game.startGame(input);
+    return 0;
+}
+
+int runBatch(const std::string& filename, int sessions, std::shared_ptr<const GameData> data, uint64_t seed) {
+    auto lines = loadScript(filename);
+    NullSink output;
+    int wins = 0;
+    long long turns = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < sessions; ++i) {
+        // Same seed, one stream per session: reproducible but not identical runs
+        ScriptInput input(lines);
+        GameEngine game(output, data, seed, static_cast<uint64_t>(i));
+        game.startGame(input);
+
+        if (game.hasWon()) wins++;
+        turns += game.getTurnsPlayed();
+    }
+    size_t outputBytes = output.bytesWritten();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Sessions: " << sessions << std::endl;
+    std::cout << "Wins: " << wins << std::endl;
+    std::cout << "Turns: " << turns << std::endl;
+    std::cout << "Output bytes: " << outputBytes << std::endl;
+    std::cout << "Elapsed: " << elapsed * 1000.0 << " ms" << std::endl;
+    if (elapsed > 0) {
+        std::cout << "Sessions/sec: " << static_cast<long long>(sessions / elapsed) << std::endl;
+    }
+    return 0;
+}
+
+int runServer(const std::string& address, std::shared_ptr<const GameData> data, uint64_t seed, const std::string& journalDirectory, Metrics* metrics) {
+    GameServer server(address, data, seed);
+    server.setJournalDirectory(journalDirectory);
+    server.setMetrics(metrics);
+    server.run();
+    return 0;
+}
+
+int runBalance(size_t fights, std::shared_ptr<const GameData> data, uint64_t seed) {
+    // Unarmed, then every weapon the content has, weakest first
+    std::vector<int> weaponBonuses{0};
+    for (const Item& item : data->items) {
+        if (item.getType() == Item::Type::WEAPON) {
+            weaponBonuses.push_back(item.getEffect());
+        }
+    }
+    std::sort(weaponBonuses.begin(), weaponBonuses.end());
+    weaponBonuses.erase(std::unique(weaponBonuses.begin(), weaponBonuses.end()), weaponBonuses.end());
+
+    Player player("Simulation", *data);
+    BatchCombat::Stats playerStats = BatchCombat::statsOf(player);
+    BatchCombat batch(seed);
+
+    std::cout << std::left << std::setw(18) << "Enemy" << std::setw(8) << "Weapon"
+              << std::setw(10) << "Win %" << std::setw(10) << "Rounds" << "HP left" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (const Enemy& enemy : data->enemies) {
+        for (int bonus : weaponBonuses) {
+            BatchCombat::Stats armed = playerStats;
+            armed.attack += bonus;
+
+            batch.clear();
+            batch.addFights(armed, BatchCombat::statsOf(enemy), fights);
+            batch.resolveAll();
+            auto summary = batch.summarize();
+            total += summary.fights;
+
+            std::cout << std::left << std::setw(18) << enemy.getName() << std::setw(8) << ("+" + std::to_string(bonus))
+                      << std::setw(10) << std::fixed << std::setprecision(1)
+                      << (100.0 * summary.playerWins / summary.fights)
+                      << std::setw(10) << summary.averageRounds << summary.averagePlayerHealth << std::endl;
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\nFights: " << total << " in " << std::setprecision(1) << elapsed * 1000.0 << " ms" << std::endl;
+    return 0;
+}
+
+int runReplay(const std::string& filename, int runs, std::shared_ptr<const GameData> data) {
+    Journal journal = Journal::load(filename, *data);
+    
+    // Replays must end the way the recording did; journals cut short by a crash cannot be checked
+    auto check = [&journal](const GameEngine& game) {
+        if (journal.finished && (game.getTurnsPlayed() != journal.turnsPlayed || game.hasWon() != journal.won)) {
+            std::cerr << "Replay diverged: recorded " << journal.turnsPlayed << " turns"
+                      << (journal.won ? " (won)" : "") << ", replayed " << game.getTurnsPlayed() << " turns"
+                      << (game.hasWon() ? " (won)" : "") << std::endl;
+            return false;
+        }
+        return true;
+    };
+    
+    if (runs == 0) {
+        StreamSink output(std::cout);
+        GameEngine game(output, data, journal.seed, journal.stream);
+        game.replay(journal);
+        return check(game) ? 0 : 1;
+    }
+    
+    NullSink output;
+    long long turns = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+        GameEngine game(output, data, journal.seed, journal.stream);
+        game.replay(journal);
+        if (!check(game)) return 1;
+        turns += game.getTurnsPlayed();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Replays: " << runs << std::endl;
+    std::cout << "Lines: " << journal.entries.size() << " per replay" << std::endl;
+    std::cout << "Turns: " << turns << std::endl;
+    std::cout << "Output bytes: " << output.bytesWritten() << std::endl;
+    std::cout << "Elapsed: " << elapsed * 1000.0 << " ms" << std::endl;
+    if (elapsed > 0) {
+        std::cout << "Replays/sec: " << static_cast<long long>(runs / elapsed) << std::endl;
+    }
+    return 0;
+}
+
+int runSelfCheck(std::shared_ptr<const GameData> data, uint64_t seed) {
+    bool passed = true;
+    auto check = [&passed](const char* name, bool result) {
+        std::cout << name << ": " << (result ? "ok" : "FAILED") << std::endl;
+        passed = passed && result;
+    };
+    check("routes", SelfCheck::routes(seed, std::cout));
+    check("saves", SelfCheck::saves(data, seed, std::cout));
+    return passed ? 0 : 1;
+}
+
+int runSolve(size_t maxStates, std::shared_ptr<const GameData> data, uint64_t seed) {
+    Solver solver(data, seed);
+
+    auto start = std::chrono::steady_clock::now();
+    Solver::Result result = solver.solve(200, maxStates);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The script goes to stdout so it can be saved and replayed with --script
+    for (const auto& command : result.commands) {
+        std::cout << command << "\n";
+    }
+    std::cerr << (result.solved ? "Solved" : "No solution found") << " with seed " << seed
+              << ": " << result.commands.size() << " commands, " << result.statesExplored
+              << " states explored, depth " << result.depth << ", "
+              << std::fixed << std::setprecision(1) << elapsed * 1000.0 << " ms" << std::endl;
+    return result.solved ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Sessions flush once per turn themselves; no need to keep stdio in lockstep
+    std::ios::sync_with_stdio(false);
+    
     try {
-        GameEngine game;
-        game.startGame();
+        std::vector<std::string> args(argv + 1, argv + argc);
+        
+        uint64_t seed = 0;
+        bool seeded = false;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == "--seed") {
+                seed = std::stoull(args[i + 1]);
+                seeded = true;
+                args.erase(args.begin() + i, args.begin() + i + 2);
+                break;
+            }
+        }
+        if (!seeded) {
+            seed = Random::randomSeed();
+        }
+
+        std::string dataDirectory;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == "--data") {
+                dataDirectory = args[i + 1];
+                args.erase(args.begin() + i, args.begin() + i + 2);
+                break;
+            }
+        }
+
+        size_t generatedRooms = 0;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == "--generate") {
+                generatedRooms = std::stoul(args[i + 1]);
+                args.erase(args.begin() + i, args.begin() + i + 2);
+                break;
+            }
+        }
+
+        std::string imagePath;
+        std::string compilePath;
+        for (size_t i = 0; i + 1 < args.size();) {
+            if (args[i] == "--world" || args[i] == "--compile-world") {
+                (args[i] == "--world" ? imagePath : compilePath) = args[i + 1];
+                args.erase(args.begin() + i, args.begin() + i + 2);
+            } else {
+                ++i;
+            }
+        }
+
+        std::shared_ptr<const GameData> data;
+        if (!imagePath.empty()) {
+            auto content = dataDirectory.empty() ? FileManager::builtinContent() : FileManager::loadContent(dataDirectory);
+            data = WorldImage::load(std::move(content), imagePath);
+        } else if (generatedRooms > 0) {
+            auto content = dataDirectory.empty() ? FileManager::builtinContent() : FileManager::loadContent(dataDirectory);
+            auto start = std::chrono::steady_clock::now();
+            data = WorldGenerator::generate(std::move(content), generatedRooms, seed);
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cerr << "Generated " << generatedRooms << " rooms with seed " << seed << " in "
+                      << std::fixed << std::setprecision(1) << elapsed * 1000.0 << " ms" << std::endl;
+            std::cerr << std::defaultfloat;
+        } else if (!dataDirectory.empty()) {
+            data = FileManager::loadDirectory(dataDirectory);
+        } else {
+            data = FileManager::builtinData();
+        }
+
+        if (!compilePath.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            WorldImage::write(*data, compilePath);
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cerr << "Compiled " << data->roomCount() << " rooms to " << compilePath << " in "
+                      << std::fixed << std::setprecision(1) << elapsed * 1000.0 << " ms" << std::endl;
+            return 0;
+        }
+
+        std::string journalPath;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == "--record") {
+                journalPath = args[i + 1];
+                args.erase(args.begin() + i, args.begin() + i + 2);
+                break;
+            }
+        }
+
+        // Dumped once more when the session or server is over
+        std::unique_ptr<Metrics> metrics;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == "--metrics") {
+                metrics = std::make_unique<Metrics>();
+                metrics->setDumpFile(args[i + 1], METRICS_INTERVAL);
+                args.erase(args.begin() + i, args.begin() + i + 2);
+                break;
+            }
+        }
+        auto finalDump = [&metrics](int status) {
+            if (metrics) metrics->dump();
+            return status;
+        };
+
+        if (args.empty()) {
+            return finalDump(runInteractive(data, seed, journalPath, metrics.get()));
+        }
+
+        const std::string& mode = args[0];
+        if (mode == "--script" && args.size() == 2) {
+            return finalDump(runScript(args[1], data, seed, journalPath, metrics.get()));
+        }
+        if (mode == "--batch" && (args.size() == 2 || args.size() == 3)) {
+            int sessions = args.size() == 3 ? std::stoi(args[2]) : 1000;
+            return runBatch(args[1], sessions, data, seed);
+        }
+
+        if (mode == "--server" && args.size() == 2) {
+            return finalDump(runServer(args[1], data, seed, journalPath, metrics.get()));
+        }
+
+        if (mode == "--balance" && (args.size() == 1 || args.size() == 2)) {
+            size_t fights = args.size() == 2 ? std::stoul(args[1]) : 100000;
+            return runBalance(fights, data, seed);
+        }
+
+        if (mode == "--replay" && (args.size() == 2 || args.size() == 3)) {
+            int runs = args.size() == 3 ? std::stoi(args[2]) : 0;
+            return runReplay(args[1], runs, data);
+        }
+
+        if (mode == "--solve" && (args.size() == 1 || args.size() == 2)) {
+            size_t states = args.size() == 2 ? std::stoul(args[1]) : 1000000;
+            return runSolve(states, data, seed);
+        }
+
+        if (mode == "--selfcheck" && args.size() == 1) {
+            return runSelfCheck(data, seed);
+        }
+
+        printUsage(argv[0]);
+        return 1;
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -15,6 +374,6 @@ int main() {
         std::cerr << "Unknown error occurred" << std::endl;
         return 1;
     }
-    
+
     return 0;
 }